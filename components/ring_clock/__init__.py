@@ -1,10 +1,44 @@
+import fnmatch
+import glob
+import gzip
+import hashlib
+import json
+import os
+import struct
+
 import esphome.config_validation as cv
 import esphome.codegen as cg
-from esphome import automation
-from esphome.const import CONF_ID, CONF_TRIGGER_ID
-from esphome.components import time as time_, light, switch, sensor
+from esphome import automation, pins
+from esphome.core import ID
+from esphome.const import (
+    CONF_ID,
+    CONF_TRIGGER_ID,
+    CONF_TEMPERATURE,
+    CONF_HUMIDITY,
+    DEVICE_CLASS_DURATION,
+    DEVICE_CLASS_TEMPERATURE,
+    DEVICE_CLASS_HUMIDITY,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_CELSIUS,
+    UNIT_MILLISECOND,
+    UNIT_PERCENT,
+    UNIT_SECOND,
+)
+from esphome.components import (
+    time as time_,
+    light,
+    switch,
+    sensor,
+    binary_sensor,
+    text_sensor,
+    web_server_base,
+)
+from esphome.components.web_server_base import CONF_WEB_SERVER_BASE_ID
 
 DEPENDENCIES = ["network"]
+AUTO_LOAD = ["web_server_base", "binary_sensor", "text_sensor"]
 
 CONF_ON_READY = 'on_ready'
 CONF_ON_TIMER_FINISHED = 'on_timer_finished'
@@ -15,6 +49,49 @@ CONF_ON_TIMER_STOPPED = 'on_timer_stopped'
 CONF_ON_STOPWATCH_STARTED = 'on_stopwatch_started'
 CONF_ON_STOPWATCH_PAUSED = 'on_stopwatch_paused'
 CONF_ON_STOPWATCH_RESET = 'on_stopwatch_reset'
+CONF_ON_STOPWATCH_LAP = 'on_stopwatch_lap'
+CONF_ON_TIME_STEP = 'on_time_step'
+CONF_ON_TIME_ADJUSTED = 'on_time_adjusted'
+CONF_ON_CHORD_HOLD = 'on_chord_hold'
+CONF_ON_CHORD_RELEASE = 'on_chord_release'
+CONF_BUTTONS = 'buttons'
+CONF_TIMEZONE_DATABASE = 'timezone_database'
+CONF_RAW_DATA_ID = 'raw_data_id'
+CONF_PREVIEW = 'preview'
+CONF_MIN_INTERVAL = 'min_interval'
+CONF_REPLAY = 'replay'
+CONF_AMBIENT_SAMPLING = 'ambient_sampling'
+CONF_BLANK_RADIUS = 'blank_radius'
+CONF_THERMAL_COMPENSATION = 'thermal_compensation'
+CONF_ECO = 'eco'
+CONF_DETAIL = 'detail'
+CONF_FAST_BOOT = 'fast_boot'
+CONF_SETTINGS = 'settings'
+CONF_PHASE_LOCK = 'phase_lock'
+CONF_FRAME_OVERLAY = 'frame_overlay'
+CONF_HISTORY = 'history'
+CONF_NET_WORKER = 'net_worker'
+CONF_LOOP_TRACE = 'loop_trace'
+CONF_WEB_SETUP_ID = 'web_setup_id'
+CONF_LOCAL_ASSETS = 'local_assets'
+CONF_STOPWATCH = 'stopwatch'
+CONF_FACES = 'faces'
+# Time-in-state sensors, indexed like the C++ EcoState enum
+ECO_TIME_SENSORS = ["full_time", "vacant_time", "dark_time"]
+CONF_SLICE_BUDGET = 'slice_budget'
+
+# The zone files and web UI assets live in static/ at the repository root.
+DEFAULT_STATIC_DIR = os.path.join(os.path.dirname(__file__), "..", "..", "static")
+DEFAULT_ASSET_FILES = ["www.js", "bg.webp", "*.json"]
+ASSET_CONTENT_TYPES = {
+    ".js": "application/javascript",
+    ".json": "application/json",
+    ".html": "text/html",
+    ".css": "text/css",
+    ".webp": "image/webp",
+    ".png": "image/png",
+    ".svg": "image/svg+xml",
+}
 
 light_ns = cg.esphome_ns.namespace("light")
 LightState = light_ns.class_("LightState", cg.Component)
@@ -23,15 +100,139 @@ AddressableLightState = light_ns.class_("LightState", LightState)
 # C++ namespace
 ns = cg.esphome_ns.namespace("ring_clock")
 RingClock = ns.class_("RingClock", cg.Component)
+SettingsStore = ns.class_("SettingsStore", cg.Component)
+RingClockWebSetup = ns.class_("RingClockWebSetup", cg.Component)
+PhaseRole = ns.enum("PhaseRole")
+OverlayProtocol = ns.enum("OverlayProtocol")
+OVERLAY_PROTOCOLS = {
+    "ddp": OverlayProtocol.OVERLAY_DDP,
+    "e131": OverlayProtocol.OVERLAY_E131,
+}
+OVERLAY_DEFAULT_PORTS = {"ddp": 4048, "e131": 5568}
+PHASE_ROLES = {
+    "follower": PhaseRole.PHASE_FOLLOWER,
+    "leader": PhaseRole.PHASE_LEADER,
+}
 ReadyTrigger = ns.class_('ReadyTrigger', automation.Trigger.template())
-TimerFinishedTrigger = ns.class_('TimerFinishedTrigger', automation.Trigger.template())
+TimerFinishedTrigger = ns.class_('TimerFinishedTrigger', automation.Trigger.template(cg.uint8))
 StopwatchMinuteTrigger = ns.class_('StopwatchMinuteTrigger', automation.Trigger.template())
 AlarmTriggeredTrigger = ns.class_('AlarmTriggeredTrigger', automation.Trigger.template())
-TimerStartedTrigger = ns.class_('TimerStartedTrigger', automation.Trigger.template())
-TimerStoppedTrigger = ns.class_('TimerStoppedTrigger', automation.Trigger.template())
+TimerStartedTrigger = ns.class_('TimerStartedTrigger', automation.Trigger.template(cg.uint8))
+TimerStoppedTrigger = ns.class_('TimerStoppedTrigger', automation.Trigger.template(cg.uint8))
 StopwatchStartedTrigger = ns.class_('StopwatchStartedTrigger', automation.Trigger.template())
 StopwatchPausedTrigger = ns.class_('StopwatchPausedTrigger', automation.Trigger.template())
 StopwatchResetTrigger = ns.class_('StopwatchResetTrigger', automation.Trigger.template())
+StopwatchLapTrigger = ns.class_('StopwatchLapTrigger',
+                                automation.Trigger.template(cg.uint16, cg.uint32, cg.uint32))
+TimeStepTrigger = ns.class_('TimeStepTrigger', automation.Trigger.template(cg.bool_))
+TimeAdjustedTrigger = ns.class_('TimeAdjustedTrigger', automation.Trigger.template())
+ChordHoldTrigger = ns.class_('ChordHoldTrigger', automation.Trigger.template())
+ChordReleaseTrigger = ns.class_('ChordReleaseTrigger', automation.Trigger.template(cg.uint32))
+
+# Custom face bytecode, values as in face_program.h
+FACE_SHAPES = {"fill": 1, "arc": 2, "dot": 3}
+FACE_RINGS = {"inner": 0, "outer": 1, "markers": 2}
+FACE_BLENDS = {"over": 0, "add": 1, "max": 2}
+FACE_SOURCES = {"second": 1, "minute": 2, "hour": 3, "hour24": 4, "phase": 5}
+FACE_EASINGS = {
+    "linear": 0, "in": 1, "out": 2, "in_out": 3, "sine": 4, "pingpong": 5, "step": 6,
+}
+# Colours bound to the customisation lights
+FACE_COLORS = {"hour": 1, "minute": 2, "second": 3, "marker": 4, "notification": 5}
+FACE_Q12_MAX = 32767 / 4096
+FACE_LAYER_LEN = 43
+
+
+def face_number(value):
+    return cv.float_range(min=-FACE_Q12_MAX, max=FACE_Q12_MAX)(value)
+
+
+FACE_BINDING_SCHEMA = cv.Schema({
+    cv.Required("source"): cv.one_of(*FACE_SOURCES, lower=True),
+    cv.Optional("easing", default="linear"): cv.one_of(*FACE_EASINGS, lower=True),
+    cv.Optional("period"): cv.positive_time_period_milliseconds,
+    cv.Optional("scale", default=1.0): face_number,
+    cv.Optional("offset", default=0.0): face_number,
+})
+
+
+def face_value(value):
+    """A constant, or a binding {source, easing, period, scale, offset}."""
+    if not isinstance(value, dict):
+        return face_number(value)
+    value = FACE_BINDING_SCHEMA(value)
+    period = value.get("period")
+    if value["source"] == "phase" and period is None:
+        raise cv.Invalid("source: phase needs a period")
+    if period is not None and not 0 < period.total_milliseconds <= 65535:
+        raise cv.Invalid("period must be between 1ms and 65535ms")
+    return value
+
+
+def face_color(value):
+    """A light name from FACE_COLORS, "#RRGGBB" or [r, g, b]."""
+    if isinstance(value, list):
+        if len(value) != 3:
+            raise cv.Invalid("color must be [r, g, b]")
+        return [cv.int_range(min=0, max=255)(v) for v in value]
+    value = cv.string_strict(value)
+    if value.startswith("#"):
+        if len(value) != 7:
+            raise cv.Invalid("color must be #RRGGBB")
+        try:
+            return [int(value[i:i + 2], 16) for i in (1, 3, 5)]
+        except ValueError as err:
+            raise cv.Invalid(f"Invalid color {value}") from err
+    return cv.one_of(*FACE_COLORS, lower=True)(value)
+
+
+FACE_LAYER_SCHEMA = cv.Schema({
+    cv.Required("shape"): cv.one_of(*FACE_SHAPES, lower=True),
+    cv.Optional("ring", default="inner"): cv.one_of(*FACE_RINGS, lower=True),
+    cv.Optional("start", default=0.0): face_value,
+    cv.Optional("length", default=0.0): face_value,
+    cv.Optional("width", default=1.0): face_value,
+    cv.Optional("opacity", default=1.0): face_value,
+    cv.Required("color"): face_color,
+    cv.Optional("color_to"): face_color,
+    cv.Optional("blend", default="over"): cv.one_of(*FACE_BLENDS, lower=True),
+})
+
+
+def validate_face_names(faces):
+    names = [f["name"] for f in faces]
+    for name in names:
+        if names.count(name) > 1:
+            raise cv.Invalid(f"Duplicate face name {name}")
+    return faces
+
+
+def validate_multicast_group(value):
+    value = cv.ipv4address(value)
+    if not 224 <= int(str(value).split(".")[0]) <= 239:
+        raise cv.Invalid(f"{value} is not an IPv4 multicast address")
+    return value
+
+
+# About 740 bytes of RAM per hour of 1-minute samples (blocks are sized for
+# the widest deltas), about 18 KB for 24 h.
+HISTORY_MAX_SAMPLES = 2880
+
+
+def validate_history_size(config):
+    samples = config["duration"].total_seconds // config["interval"].total_seconds
+    if samples > HISTORY_MAX_SAMPLES:
+        raise cv.Invalid(f"history holds at most {HISTORY_MAX_SAMPLES} samples "
+                         f"(duration / interval), not {samples}")
+    return config
+
+
+def overlay_default_port(config):
+    if "port" not in config:
+        config = dict(config)
+        config["port"] = OVERLAY_DEFAULT_PORTS[config["protocol"]]
+    return config
+
 
 CONFIG_SCHEMA = cv.Schema({
     cv.GenerateID(): cv.declare_id(RingClock),
@@ -48,6 +249,10 @@ CONFIG_SCHEMA = cv.Schema({
     cv.Required("marker_color"): cv.use_id(light.LightState),
     cv.Required("notification_color"): cv.use_id(light.LightState),
     cv.Required("sound_enabled_switch"): cv.use_id(switch.Switch),
+    # Crossfade between faces on a state change (0s = instant cut)
+    cv.Optional("transition_length", default="300ms"): cv.All(
+        cv.positive_time_period_milliseconds,
+        cv.Range(max=cv.TimePeriod(seconds=5))),
     # Sensors
     cv.Optional("temperature_sensor"): cv.use_id(sensor.Sensor),
     cv.Optional("humidity_sensor"): cv.use_id(sensor.Sensor),
@@ -60,6 +265,237 @@ CONFIG_SCHEMA = cv.Schema({
         cv.Required("value"): cv.float_,
         cv.Required("color"): cv.All(cv.ensure_list(cv.int_), cv.Length(min=3, max=3)),
     })),
+    # Light sensor read inside a one-frame blanking window (sensor's own
+    # update_interval should be `never`)
+    cv.Optional(CONF_AMBIENT_SAMPLING): cv.Schema({
+        # A polled sensor such as adc; also used by interference calibration
+        cv.Required("sensor"): cv.use_id(sensor.Sensor),
+        cv.Optional("interval", default="1s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_BLANK_RADIUS, default=1): cv.int_range(min=0, max=3),
+    }),
+    # Eco rendering: static face when the room is empty or dark
+    cv.Optional(CONF_ECO): cv.Schema({
+        cv.Optional("occupancy"): cv.use_id(binary_sensor.BinarySensor),
+        cv.Optional("light_sensor"): cv.use_id(sensor.Sensor),
+        # In the light sensor's units; leave the dark state above
+        # dark_below + hysteresis
+        cv.Optional("dark_below", default=3.0): cv.float_,
+        cv.Optional("hysteresis", default=2.0): cv.float_range(min=0.0),
+        cv.Optional("state"): text_sensor.text_sensor_schema(
+            icon="mdi:leaf",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        **{
+            cv.Optional(key): sensor.sensor_schema(
+                unit_of_measurement=UNIT_SECOND,
+                accuracy_decimals=0,
+                device_class=DEVICE_CLASS_DURATION,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            )
+            for key in ECO_TIME_SENSORS
+        },
+    }),
+    # Render level of detail from the radar distance: a simpler face at a
+    # lower frame rate for viewers across the room
+    cv.Optional(CONF_DETAIL): cv.All(cv.Schema({
+        cv.Optional("moving_distance"): cv.use_id(sensor.Sensor),
+        cv.Optional("still_distance"): cv.use_id(sensor.Sensor),
+        # In the distance sensors' units (cm for the LD2410); leave the far
+        # face below far_above - hysteresis
+        cv.Optional("far_above", default=250.0): cv.positive_float,
+        cv.Optional("hysteresis", default=50.0): cv.float_range(min=0.0),
+        cv.Optional("switch_delay", default="3s"): cv.positive_time_period_milliseconds,
+        cv.Optional("far_interval", default="200ms"): cv.positive_time_period_milliseconds,
+        cv.Optional("state"): text_sensor.text_sensor_schema(
+            icon="mdi:eye-arrow-right-outline",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }), cv.has_at_least_one_key("moving_distance", "still_distance")),
+    # Self-heating compensation for the temperature/humidity sensor, driven
+    # by the LED power in the frame buffer
+    cv.Optional(CONF_THERMAL_COMPENSATION): cv.Schema({
+        cv.Required("raw_temperature"): cv.use_id(sensor.Sensor),
+        cv.Optional("raw_humidity"): cv.use_id(sensor.Sensor),
+        cv.Required(CONF_TEMPERATURE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_CELSIUS,
+            accuracy_decimals=1,
+            device_class=DEVICE_CLASS_TEMPERATURE,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_HUMIDITY): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_HUMIDITY,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        # Steady-state rise with the LEDs dark (MCU, radio, LED drivers)
+        cv.Optional("base_rise", default=8.0): cv.float_range(min=0.0, max=30.0),
+        # Additional rise per watt emitted by the LEDs
+        cv.Optional("led_coefficient", default=0.8): cv.float_range(min=0.0, max=20.0),
+        # How quickly the sensor follows a change in dissipated power
+        cv.Optional("time_constant", default="20min"): cv.positive_time_period_seconds,
+        # Electrical power of one LED channel at full output (WS2812: ~12 mA at 5 V)
+        cv.Optional("led_channel_power", default="60mW"): cv.power,
+    }),
+    # Hour/minute buttons handled natively (replaces gpio binary_sensors)
+    cv.Optional(CONF_BUTTONS): cv.Schema({
+        cv.Required("hour_pin"): pins.internal_gpio_input_pin_schema,
+        cv.Required("minute_pin"): pins.internal_gpio_input_pin_schema,
+        cv.Optional("debounce", default="30ms"): cv.positive_time_period_milliseconds,
+        # First auto-repeat step after this long
+        cv.Optional("repeat_delay", default="600ms"): cv.positive_time_period_milliseconds,
+        # Repeat interval ramps from repeat_interval to repeat_min_interval
+        # over repeat_ramp of holding
+        cv.Optional("repeat_interval", default="250ms"): cv.positive_time_period_milliseconds,
+        cv.Optional("repeat_min_interval", default="50ms"): cv.positive_time_period_milliseconds,
+        cv.Optional("repeat_ramp", default="3s"): cv.positive_time_period_milliseconds,
+    }),
+    # Draw the first frame from setup(), before the network comes up
+    cv.Optional(CONF_FAST_BOOT): cv.Schema({
+        # Hardware RTC with a read_time() method (pcf8563, ds1307, ...)
+        cv.Required("rtc_id"): cv.use_id(time_.RealTimeClock),
+        # Milliseconds from app start to the first frame on the rings
+        cv.Optional("first_frame_time"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }),
+    # All restore_value state in one NVS blob, written after a quiet period
+    cv.Optional(CONF_SETTINGS): cv.All(cv.Schema({
+        cv.GenerateID(): cv.declare_id(SettingsStore),
+        cv.Optional("quiet_period", default="10s"): cv.positive_time_period_milliseconds,
+        cv.Optional("commits"): sensor.sensor_schema(
+            icon="mdi:content-save-outline",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }), cv.only_on_esp32),
+    # Sensor history for the trend faces and /ring_clock/history.bin
+    cv.Optional(CONF_HISTORY): cv.All(cv.Schema({
+        cv.Optional("interval", default="60s"): cv.All(
+            cv.positive_time_period_seconds,
+            cv.Range(min=cv.TimePeriod(seconds=10), max=cv.TimePeriod(hours=1))),
+        cv.Optional("duration", default="24h"): cv.All(
+            cv.positive_time_period_seconds,
+            cv.Range(min=cv.TimePeriod(hours=1), max=cv.TimePeriod(days=7))),
+    }), validate_history_size),
+    # DDP / E1.31 pixels over UDP, blended on top of the clock face
+    cv.Optional(CONF_FRAME_OVERLAY): cv.All(cv.Schema({
+        cv.Optional("protocol", default="ddp"): cv.one_of(*OVERLAY_PROTOCOLS, lower=True),
+        cv.Optional("port"): cv.port,
+        cv.Optional("universe", default=1): cv.int_range(min=1, max=63999),
+        cv.Optional("rgba", default=False): cv.boolean,
+        cv.Optional("timeout", default="2500ms"): cv.positive_time_period_milliseconds,
+    }), overlay_default_port, cv.only_on_esp32),
+    # Seconds tick in unison with a UDP multicast beacon on the LAN
+    cv.Optional(CONF_PHASE_LOCK): cv.All(cv.Schema({
+        cv.Optional("role", default="follower"): cv.enum(PHASE_ROLES, lower=True),
+        cv.Optional("group", default="239.255.60.60"): validate_multicast_group,
+        cv.Optional("port", default=6060): cv.port,
+        cv.Optional("phase_error"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            icon="mdi:sine-wave",
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }), cv.only_on_esp32),
+    # Main loop profiler: which component delays the LED frames
+    cv.Optional(CONF_LOOP_TRACE): cv.All(cv.Schema({
+        # Off: nothing is compiled in (e.g. `enabled: ${debug}` in a package)
+        cv.Optional("enabled", default=True): cv.boolean,
+        cv.Optional("sample_interval", default="2ms"): cv.All(
+            cv.positive_time_period_microseconds,
+            cv.Range(min=cv.TimePeriod(microseconds=500), max=cv.TimePeriod(milliseconds=20))),
+        cv.Optional("stall_threshold", default="20ms"): cv.positive_time_period_milliseconds,
+        cv.Optional("gap_threshold", default="100ms"): cv.positive_time_period_milliseconds,
+        cv.Optional("publish_interval", default="60s"): cv.positive_time_period_milliseconds,
+        cv.Optional("worst_component"): text_sensor.text_sensor_schema(
+            icon="mdi:timer-alert-outline",
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional("worst_stall"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            icon="mdi:timer-sand",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional("frame_gap"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            icon="mdi:filmstrip-off",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional("loop_load"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_PERCENT,
+            icon="mdi:gauge",
+            accuracy_decimals=1,
+            state_class=STATE_CLASS_MEASUREMENT,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }), cv.only_on_esp32),
+    # HTTP GETs with JSON field extraction on a background task
+    cv.Optional(CONF_NET_WORKER): cv.All(cv.Schema({
+        cv.Optional("max_body_size", default="16KB"): cv.All(
+            cv.validate_bytes, cv.int_range(min=1024, max=262144)),
+        cv.Optional("stack_size", default=8192): cv.int_range(min=6144, max=16384),
+    }), cv.only_on_esp32),
+    # HTTP endpoints on the existing web server (port 80)
+    cv.GenerateID(CONF_WEB_SERVER_BASE_ID): cv.use_id(web_server_base.WebServerBase),
+    cv.GenerateID(CONF_WEB_SETUP_ID): cv.declare_id(RingClockWebSetup),
+    # Live LED frame preview at /ring_clock/frame
+    cv.Optional(CONF_PREVIEW): cv.Schema({
+        cv.Optional(CONF_MIN_INTERVAL, default="100ms"): cv.positive_time_period_milliseconds,
+    }),
+    # Stopwatch lap sensors
+    cv.Optional(CONF_STOPWATCH): cv.Schema({
+        cv.Optional("last_lap"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            icon="mdi:timer-outline",
+            accuracy_decimals=3,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional("best_lap"): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            icon="mdi:trophy-outline",
+            accuracy_decimals=3,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional("lap_count"): sensor.sensor_schema(
+            icon="mdi:counter",
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+    }),
+    # Web UI assets gzipped into flash, served at /ring_clock/static/<file>
+    cv.Optional(CONF_LOCAL_ASSETS): cv.Schema({
+        cv.Optional("path", default=DEFAULT_STATIC_DIR): cv.directory,
+        cv.Optional("files", default=DEFAULT_ASSET_FILES): cv.ensure_list(cv.string_strict),
+        cv.Optional("max_age", default="1d"): cv.positive_time_period_seconds,
+    }),
+    # Custom faces, compiled to bytecode (see compile_face)
+    cv.Optional(CONF_FACES): cv.All(cv.ensure_list(cv.Schema({
+        cv.Required("name"): cv.string_strict,
+        cv.Required("layers"): cv.All(cv.ensure_list(FACE_LAYER_SCHEMA), cv.Length(min=1, max=255)),
+    })), validate_face_names),
+    # Time-warp replay for soak testing (debug builds only)
+    cv.Optional(CONF_REPLAY): cv.Schema({
+        cv.Optional(CONF_SLICE_BUDGET, default="8ms"): cv.positive_time_period_microseconds,
+    }),
+    # Offline IANA -> POSIX timezone table compiled into flash
+    cv.Optional(CONF_TIMEZONE_DATABASE): cv.Schema({
+        cv.GenerateID(CONF_RAW_DATA_ID): cv.declare_id(cg.uint8),
+        cv.Optional("path", default=DEFAULT_STATIC_DIR): cv.directory,
+    }),
     # Event handlers
     cv.Optional(CONF_ON_READY): automation.validate_automation({
         cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ReadyTrigger),
@@ -88,8 +524,143 @@ CONFIG_SCHEMA = cv.Schema({
     cv.Optional(CONF_ON_STOPWATCH_RESET): automation.validate_automation({
         cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(StopwatchResetTrigger),
     }),
+    cv.Optional(CONF_ON_STOPWATCH_LAP): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(StopwatchLapTrigger),
+    }),
+    cv.Optional(CONF_ON_TIME_STEP): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(TimeStepTrigger),
+    }),
+    cv.Optional(CONF_ON_TIME_ADJUSTED): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(TimeAdjustedTrigger),
+    }),
+    cv.Optional(CONF_ON_CHORD_HOLD): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ChordHoldTrigger),
+        cv.Required("hold_time"): cv.positive_time_period_milliseconds,
+    }),
+    cv.Optional(CONF_ON_CHORD_RELEASE): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ChordReleaseTrigger),
+    }),
 }).extend(cv.COMPONENT_SCHEMA)
 
+def build_local_assets(path, patterns):
+    """Collect the files in path matching patterns for /ring_clock/static/.
+
+    Each is gzipped unless that saves less than 5% (e.g. WebP), and gets an
+    ETag from a hash of its contents. Yields (name, content type, bytes,
+    etag, gzipped).
+    """
+    names = sorted(os.listdir(path))
+    picked = []
+    for pattern in patterns:
+        matches = [n for n in names if fnmatch.fnmatch(n, pattern)]
+        if not matches:
+            raise cv.Invalid(f"No files matching {pattern} in {path}")
+        picked.extend(n for n in matches if n not in picked)
+    for name in picked:
+        ext = os.path.splitext(name)[1].lower()
+        if ext not in ASSET_CONTENT_TYPES:
+            raise cv.Invalid(f"Unknown content type for {name}")
+        with open(os.path.join(path, name), "rb") as f:
+            raw = f.read()
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        gzipped = len(packed) < len(raw) * 0.95
+        etag = '"' + hashlib.sha256(raw).hexdigest()[:16] + '"'
+        yield name, ASSET_CONTENT_TYPES[ext], packed if gzipped else raw, etag, gzipped
+
+
+def compile_face(face):
+    """Compile one `faces:` entry into the program run by FaceProgram.
+
+    Header 'F', version, layer count, flags; then one FACE_LAYER_LEN record
+    per layer (see face_program.h). The face is flagged animated, i.e.
+    drawn every frame, if any value follows the second hand or a phase.
+    """
+    animated = False
+
+    def value(v):
+        nonlocal animated
+        if not isinstance(v, dict):
+            return struct.pack("<BBHhh", 0, 0, 0, 0, round(v * 4096))
+        if v["source"] in ("second", "phase"):
+            animated = True
+        period = v["period"].total_milliseconds if "period" in v else 0
+        return struct.pack("<BBHhh", FACE_SOURCES[v["source"]], FACE_EASINGS[v["easing"]],
+                           period, round(v["scale"] * 4096), round(v["offset"] * 4096))
+
+    def color(c):
+        if isinstance(c, list):
+            return struct.pack("<BBBB", 0, *c)
+        return struct.pack("<BBBB", FACE_COLORS[c], 0, 0, 0)
+
+    layers = bytearray()
+    for layer in face["layers"]:
+        gradient = "color_to" in layer
+        record = struct.pack("<BBB", FACE_SHAPES[layer["shape"]], FACE_RINGS[layer["ring"]],
+                             FACE_BLENDS[layer["blend"]] | (0x10 if gradient else 0))
+        for key in ("start", "length", "width", "opacity"):
+            record += value(layer[key])
+        record += color(layer["color"])
+        record += color(layer["color_to"] if gradient else layer["color"])
+        assert len(record) == FACE_LAYER_LEN
+        layers += record
+    header = struct.pack("<BBBB", ord("F"), 1, len(face["layers"]), 0x01 if animated else 0)
+    return bytes(header + layers)
+
+
+def build_timezone_database(path):
+    """Pack every zone in path/*.json into the binary table read by
+    TimezoneDatabase (see tz_database.h for the layout).
+
+    zones.json keys are full IANA names; the per-region files (Europe.json
+    etc.) are keyed by city and take their region from the file name.
+    """
+    zones = {}
+    for file in sorted(glob.glob(os.path.join(path, "*.json"))):
+        region = os.path.splitext(os.path.basename(file))[0]
+        with open(file, encoding="utf-8") as f:
+            data = json.load(f)
+        for name, rule in data.items():
+            full = name if region == "zones" else f"{region}/{name}"
+            if zones.setdefault(full, rule) != rule:
+                raise cv.Invalid(f"Conflicting POSIX rules for {full} in {file}")
+    if not zones:
+        raise cv.Invalid(f"No timezone files found in {path}")
+
+    pool = bytearray()
+    interned = {}
+
+    def intern(text):
+        if text not in interned:
+            interned[text] = len(pool)
+            pool.extend(text.encode("utf-8") + b"\0")
+        return interned[text]
+
+    names = sorted(zones, key=lambda n: n.encode("utf-8"))
+    regions = sorted({n.split("/", 1)[0] for n in names})
+    rules = sorted(set(zones.values()))
+    if len(regions) > 255 or len(rules) > 255:
+        raise cv.Invalid("Timezone database exceeds 255 regions or rules")
+
+    region_index = {r: i for i, r in enumerate(regions)}
+    rule_index = {r: i for i, r in enumerate(rules)}
+    region_offsets = [intern(r) for r in regions]
+    rule_offsets = [intern(r) for r in rules]
+
+    entries = bytearray()
+    for name in names:
+        region, city = name.split("/", 1)
+        entries += struct.pack("<HBB", intern(city), region_index[region], rule_index[zones[name]])
+    if len(pool) > 0xFFFF:
+        raise cv.Invalid("Timezone database string pool exceeds 64 KiB")
+
+    blob = bytearray(struct.pack("<HBB", len(names), len(regions), len(rules)))
+    blob += entries
+    blob += b"".join(struct.pack("<H", o) for o in region_offsets)
+    blob += b"".join(struct.pack("<H", o) for o in rule_offsets)
+    blob += pool
+    return bytes(blob)
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
 
@@ -119,6 +690,7 @@ async def to_code(config):
 
     wrapped_sound_enabled = await cg.get_variable(config["sound_enabled_switch"])
     cg.add(var.set_sound_enabled_state(wrapped_sound_enabled))
+    cg.add(var.set_transition_length(config["transition_length"]))
 
     if "temperature_sensor" in config:
         sens = await cg.get_variable(config["temperature_sensor"])
@@ -140,12 +712,181 @@ async def to_code(config):
             cg.add(var.add_humidity_color_point(
                 point["value"], cg.RawExpression(f"Color({c[0]}, {c[1]}, {c[2]})")))
 
+    if CONF_AMBIENT_SAMPLING in config:
+        amb = config[CONF_AMBIENT_SAMPLING]
+        adc = await cg.get_variable(amb["sensor"])
+        cg.add(var.set_ambient_sensor(adc))
+        cg.add(var.set_ambient_interval(amb["interval"]))
+        cg.add(var.set_ambient_blank_radius(amb[CONF_BLANK_RADIUS]))
+
+    if CONF_ECO in config:
+        eco = config[CONF_ECO]
+        if "occupancy" in eco:
+            occ = await cg.get_variable(eco["occupancy"])
+            cg.add(var.set_eco_occupancy(occ))
+        if "light_sensor" in eco:
+            light_sens = await cg.get_variable(eco["light_sensor"])
+            cg.add(var.set_eco_light_sensor(light_sens, eco["dark_below"], eco["hysteresis"]))
+        if "state" in eco:
+            ts = await text_sensor.new_text_sensor(eco["state"])
+            cg.add(var.set_eco_state_text_sensor(ts))
+        for index, key in enumerate(ECO_TIME_SENSORS):
+            if key in eco:
+                sens = await sensor.new_sensor(eco[key])
+                cg.add(var.set_eco_time_sensor(cg.RawExpression(f"(ring_clock::EcoState) {index}"), sens))
+
+    if CONF_DETAIL in config:
+        detail = config[CONF_DETAIL]
+        moving = cg.nullptr
+        if "moving_distance" in detail:
+            moving = await cg.get_variable(detail["moving_distance"])
+        still = cg.nullptr
+        if "still_distance" in detail:
+            still = await cg.get_variable(detail["still_distance"])
+        cg.add(var.set_detail_distance_sensors(moving, still))
+        cg.add(var.set_detail_thresholds(detail["far_above"], detail["hysteresis"],
+                                         detail["switch_delay"]))
+        cg.add(var.set_detail_far_interval(detail["far_interval"]))
+        if "state" in detail:
+            ts = await text_sensor.new_text_sensor(detail["state"])
+            cg.add(var.set_detail_state_text_sensor(ts))
+
+    if CONF_THERMAL_COMPENSATION in config:
+        th = config[CONF_THERMAL_COMPENSATION]
+        raw_temp = await cg.get_variable(th["raw_temperature"])
+        raw_humid = cg.nullptr
+        if "raw_humidity" in th:
+            raw_humid = await cg.get_variable(th["raw_humidity"])
+        temp = await sensor.new_sensor(th[CONF_TEMPERATURE])
+        humid = cg.nullptr
+        if CONF_HUMIDITY in th:
+            humid = await sensor.new_sensor(th[CONF_HUMIDITY])
+        cg.add(var.set_thermal_sensors(raw_temp, raw_humid, temp, humid))
+        cg.add(var.configure_thermal_model(
+            th["base_rise"], th["led_coefficient"],
+            th["time_constant"], th["led_channel_power"]))
+
+    if CONF_FAST_BOOT in config:
+        fb = config[CONF_FAST_BOOT]
+        rtc = await cg.get_variable(fb["rtc_id"])
+        # Set the RTC up just before ring_clock reads it, instead of at its
+        # default DATA priority after everything else.
+        cg.add(rtc.set_setup_priority(cg.RawExpression("setup_priority::HARDWARE - 1.5f")))
+        cg.add(var.set_boot_rtc(rtc))
+        if "first_frame_time" in fb:
+            sens = await sensor.new_sensor(fb["first_frame_time"])
+            cg.add(var.set_first_frame_sensor(sens))
+
+    if CONF_BUTTONS in config:
+        bt = config[CONF_BUTTONS]
+        hour_pin = await cg.gpio_pin_expression(bt["hour_pin"])
+        minute_pin = await cg.gpio_pin_expression(bt["minute_pin"])
+        cg.add(var.set_time_buttons(hour_pin, minute_pin))
+        buttons = var.get_time_buttons()
+        cg.add(buttons.set_debounce(bt["debounce"]))
+        cg.add(buttons.set_repeat(bt["repeat_delay"], bt["repeat_interval"],
+                                  bt["repeat_min_interval"], bt["repeat_ramp"]))
+
+    if CONF_SETTINGS in config:
+        st = config[CONF_SETTINGS]
+        cg.add_define("USE_RING_CLOCK_SETTINGS")
+        store = cg.new_Pvariable(st[CONF_ID])
+        await cg.register_component(store, {})
+        cg.add(store.set_quiet_period(st["quiet_period"]))
+        if "commits" in st:
+            sens = await sensor.new_sensor(st["commits"])
+            cg.add(store.set_commit_sensor(sens))
+
+    if CONF_HISTORY in config:
+        hi = config[CONF_HISTORY]
+        cg.add_define("USE_RING_CLOCK_HISTORY")
+        cg.add(var.configure_history(hi["interval"], hi["duration"]))
+
+    if CONF_FRAME_OVERLAY in config:
+        ov = config[CONF_FRAME_OVERLAY]
+        cg.add_define("USE_RING_CLOCK_FRAME_OVERLAY")
+        cg.add(var.set_frame_overlay(OVERLAY_PROTOCOLS[ov["protocol"]], ov["port"],
+                                     ov["universe"], ov["rgba"], ov["timeout"]))
+
+    if CONF_PHASE_LOCK in config:
+        pl = config[CONF_PHASE_LOCK]
+        cg.add_define("USE_RING_CLOCK_PHASE_LOCK")
+        cg.add(var.set_phase_lock(pl["role"], str(pl["group"]), pl["port"]))
+        if "phase_error" in pl:
+            sens = await sensor.new_sensor(pl["phase_error"])
+            cg.add(var.set_phase_error_sensor(sens))
+
+    if CONF_LOOP_TRACE in config and config[CONF_LOOP_TRACE]["enabled"]:
+        lt = config[CONF_LOOP_TRACE]
+        cg.add_define("USE_RING_CLOCK_LOOP_TRACE")
+        cg.add(var.set_loop_trace(lt["sample_interval"], lt["stall_threshold"],
+                                  lt["gap_threshold"], lt["publish_interval"]))
+        if "worst_component" in lt:
+            ts = await text_sensor.new_text_sensor(lt["worst_component"])
+            cg.add(var.set_trace_worst_component_text(ts))
+        for key, setter in (("worst_stall", var.set_trace_worst_stall_sensor),
+                            ("frame_gap", var.set_trace_frame_gap_sensor),
+                            ("loop_load", var.set_trace_loop_load_sensor)):
+            if key in lt:
+                sens = await sensor.new_sensor(lt[key])
+                cg.add(setter(sens))
+
+    if CONF_NET_WORKER in config:
+        nw = config[CONF_NET_WORKER]
+        cg.add_define("USE_RING_CLOCK_NET_WORKER")
+        cg.add(var.set_net_worker_max_body(nw["max_body_size"]))
+        cg.add(var.set_net_worker_stack_size(nw["stack_size"]))
+
+    web_base = await cg.get_variable(config[CONF_WEB_SERVER_BASE_ID])
+    cg.add(var.set_web_server_base(web_base))
+    # Registers the endpoints once WiFi is set up (RingClock sets up earlier).
+    web_setup = cg.new_Pvariable(config[CONF_WEB_SETUP_ID], var)
+    await cg.register_component(web_setup, {})
+
+    if CONF_PREVIEW in config:
+        cg.add(var.enable_frame_preview(config[CONF_PREVIEW][CONF_MIN_INTERVAL]))
+
+    if CONF_REPLAY in config:
+        cg.add_define("USE_RING_CLOCK_REPLAY")
+        cg.add(var.set_replay_slice_budget(config[CONF_REPLAY][CONF_SLICE_BUDGET]))
+
+    if CONF_STOPWATCH in config:
+        sw = config[CONF_STOPWATCH]
+        for key, setter in (("last_lap", var.set_last_lap_sensor),
+                            ("best_lap", var.set_best_lap_sensor),
+                            ("lap_count", var.set_lap_count_sensor)):
+            if key in sw:
+                sens = await sensor.new_sensor(sw[key])
+                cg.add(setter(sens))
+
+    if CONF_LOCAL_ASSETS in config:
+        la = config[CONF_LOCAL_ASSETS]
+        cg.add_define("USE_RING_CLOCK_LOCAL_ASSETS")
+        cg.add(var.set_local_asset_max_age(la["max_age"]))
+        for index, (name, content_type, blob, etag, gzipped) in enumerate(
+                build_local_assets(la["path"], la["files"])):
+            data_id = ID(f"ring_clock_asset_{index}", is_declaration=True, type=cg.uint8)
+            data = cg.progmem_array(data_id, list(blob))
+            cg.add(var.add_local_asset(name, content_type, data, len(blob), etag, gzipped))
+
+    for index, face in enumerate(config.get(CONF_FACES, [])):
+        blob = compile_face(face)
+        data_id = ID(f"ring_clock_face_{index}", is_declaration=True, type=cg.uint8)
+        data = cg.progmem_array(data_id, list(blob))
+        cg.add(var.add_face(face["name"], data, len(blob)))
+
+    if CONF_TIMEZONE_DATABASE in config:
+        tz_conf = config[CONF_TIMEZONE_DATABASE]
+        blob = build_timezone_database(tz_conf["path"])
+        tz_data = cg.progmem_array(tz_conf[CONF_RAW_DATA_ID], list(blob))
+        cg.add(var.set_timezone_database(tz_data, len(blob)))
+
     for conf in config.get(CONF_ON_READY, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [], conf)
     for conf in config.get(CONF_ON_TIMER_FINISHED, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
-        await automation.build_automation(trigger, [], conf)
+        await automation.build_automation(trigger, [(cg.uint8, "timer_id")], conf)
     for conf in config.get(CONF_ON_STOPWATCH_MINUTE, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [], conf)
@@ -154,10 +895,10 @@ async def to_code(config):
         await automation.build_automation(trigger, [], conf)
     for conf in config.get(CONF_ON_TIMER_STARTED, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
-        await automation.build_automation(trigger, [], conf)
+        await automation.build_automation(trigger, [(cg.uint8, "timer_id")], conf)
     for conf in config.get(CONF_ON_TIMER_STOPPED, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
-        await automation.build_automation(trigger, [], conf)
+        await automation.build_automation(trigger, [(cg.uint8, "timer_id")], conf)
     for conf in config.get(CONF_ON_STOPWATCH_STARTED, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [], conf)
@@ -167,5 +908,21 @@ async def to_code(config):
     for conf in config.get(CONF_ON_STOPWATCH_RESET, []):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [], conf)
+    for conf in config.get(CONF_ON_STOPWATCH_LAP, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trigger, [(cg.uint16, "lap"), (cg.uint32, "lap_ms"), (cg.uint32, "split_ms")], conf)
+    for conf in config.get(CONF_ON_TIME_STEP, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.bool_, "repeat")], conf)
+    for conf in config.get(CONF_ON_TIME_ADJUSTED, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
+    for conf in config.get(CONF_ON_CHORD_HOLD, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var, conf["hold_time"])
+        await automation.build_automation(trigger, [], conf)
+    for conf in config.get(CONF_ON_CHORD_RELEASE, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.uint32, "held_ms")], conf)
 
     await cg.register_component(var, config)
@@ -0,0 +1,163 @@
+#include "face_program.h"
+#include "ring_layout.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const uint8_t VALUE_LEN = 8;
+  static const uint8_t COLOR_LEN = 4;
+  // Offsets within a layer record.
+  static const uint8_t L_START = 3;
+  static const uint8_t L_LENGTH = L_START + VALUE_LEN;
+  static const uint8_t L_WIDTH = L_LENGTH + VALUE_LEN;
+  static const uint8_t L_OPACITY = L_WIDTH + VALUE_LEN;
+  static const uint8_t L_COLOR = L_OPACITY + VALUE_LEN;
+  static const uint8_t L_COLOR_TO = L_COLOR + COLOR_LEN;
+  static_assert(L_COLOR_TO + COLOR_LEN == FaceProgram::LAYER_LEN, "layer layout");
+
+  static inline int16_t read_i16(const uint8_t *p) { return (int16_t) (p[0] | (p[1] << 8)); }
+  static inline uint16_t read_u16(const uint8_t *p) { return (uint16_t) (p[0] | (p[1] << 8)); }
+
+  // LEDs of each ring and where its first LED sits in the strip.
+  static inline int ring_size(uint8_t ring) {
+    return ring == FaceProgram::RING_INNER ? R1_NUM_LEDS : ring == FaceProgram::RING_OUTER ? R2_NUM_LEDS : 12;
+  }
+  static inline int ring_led(uint8_t ring, int k) {
+    return ring == FaceProgram::RING_INNER ? k : ring == FaceProgram::RING_OUTER ? R1_NUM_LEDS + k : R1_NUM_LEDS + k * 4;
+  }
+
+  bool FaceProgram::validate(const uint8_t *code, size_t len) {
+    if (len < HEADER_LEN || code[0] != MAGIC || code[1] != VERSION) return false;
+    if (len != HEADER_LEN + code[2] * LAYER_LEN) return false;
+    for (uint8_t n = 0; n < code[2]; n++) {
+      const uint8_t *l = code + HEADER_LEN + n * LAYER_LEN;
+      if (l[0] < OP_FILL || l[0] > OP_DOT || l[1] > RING_MARKERS || (l[2] & 0x0F) > BLEND_MAX) return false;
+      if (l[L_COLOR] >= FACE_COLOR_SOURCES || l[L_COLOR_TO] >= FACE_COLOR_SOURCES) return false;
+    }
+    return true;
+  }
+
+  float FaceProgram::value(const uint8_t *v, const FaceInputs &in) {
+    const float offset = read_i16(v + 6) / 4096.0f;
+    float x;
+    switch (v[0]) {
+      case SRC_SECOND: x = in.second; break;
+      case SRC_MINUTE: x = in.minute; break;
+      case SRC_HOUR: x = in.hour; break;
+      case SRC_HOUR24: x = in.hour24; break;
+      case SRC_PHASE: {
+        const uint16_t period = read_u16(v + 2);
+        x = period > 0 ? (in.ms % period) / (float) period : 0.0f;
+        break;
+      }
+      default:
+        return offset;
+    }
+    switch (v[1]) {
+      case EASE_IN: x = x * x; break;
+      case EASE_OUT: x = 1.0f - (1.0f - x) * (1.0f - x); break;
+      case EASE_IN_OUT: x = x < 0.5f ? 2.0f * x * x : 1.0f - 2.0f * (1.0f - x) * (1.0f - x); break;
+      case EASE_SINE: x = 0.5f - 0.5f * cosf(x * 6.2831853f); break;
+      case EASE_PINGPONG: x = x < 0.5f ? 2.0f * x : 2.0f - 2.0f * x; break;
+      case EASE_STEP: x = x < 0.5f ? 0.0f : 1.0f; break;
+      default: break;
+    }
+    return x * (read_i16(v + 4) / 4096.0f) + offset;
+  }
+
+  Color FaceProgram::color(const uint8_t *c, const FaceInputs &in) {
+    return c[0] == FACE_COLOR_RGB ? Color(c[1], c[2], c[3]) : in.colors[c[0]];
+  }
+
+  // Mixes c into LED `led` with alpha 0-256.
+  static inline void put(light::AddressableLight &it, int led, Color c, uint32_t alpha, uint8_t blend) {
+    if (alpha == 0) return;
+    const Color o = it[led].get();
+    switch (blend) {
+      case FaceProgram::BLEND_ADD:
+        it[led] = Color(std::min<uint32_t>(255, o.r + ((c.r * alpha) >> 8)),
+                        std::min<uint32_t>(255, o.g + ((c.g * alpha) >> 8)),
+                        std::min<uint32_t>(255, o.b + ((c.b * alpha) >> 8)));
+        break;
+      case FaceProgram::BLEND_MAX:
+        it[led] = Color(std::max<uint32_t>(o.r, (c.r * alpha) >> 8), std::max<uint32_t>(o.g, (c.g * alpha) >> 8),
+                        std::max<uint32_t>(o.b, (c.b * alpha) >> 8));
+        break;
+      default:
+        it[led] = Color((o.r * (256 - alpha) + c.r * alpha) >> 8, (o.g * (256 - alpha) + c.g * alpha) >> 8,
+                        (o.b * (256 - alpha) + c.b * alpha) >> 8);
+        break;
+    }
+  }
+
+  static inline Color lerp(Color a, Color b, uint32_t t) {
+    return Color((a.r * (256 - t) + b.r * t) >> 8, (a.g * (256 - t) + b.g * t) >> 8, (a.b * (256 - t) + b.b * t) >> 8);
+  }
+
+  // Position as a fraction of a turn -> 1/256 LED steps on an n-LED ring.
+  static inline int32_t to_steps(float turns, int n) {
+    turns -= floorf(turns);
+    return (int32_t) (turns * n * 256.0f);
+  }
+
+  void FaceProgram::layer(const uint8_t *l, const FaceInputs &in, light::AddressableLight &it) {
+    const uint8_t op = l[0];
+    const uint8_t ring = l[1];
+    const uint8_t blend = l[2] & 0x0F;
+    const bool gradient = l[2] >> 4;
+    const float opacity = value(l + L_OPACITY, in);
+    if (opacity <= 0.0f) return;
+    const uint32_t op_alpha = opacity >= 1.0f ? 256 : (uint32_t) (opacity * 256.0f);
+    const Color c0 = color(l + L_COLOR, in);
+    const Color c1 = gradient ? color(l + L_COLOR_TO, in) : c0;
+    const int n = ring_size(ring);
+
+    if (op == OP_FILL) {
+      for (int k = 0; k < n; k++) {
+        put(it, ring_led(ring, k), gradient ? lerp(c0, c1, k * 256 / n) : c0, op_alpha, blend);
+      }
+      return;
+    }
+
+    // Span [a, a + len) in 1/256 LED steps; LED k covers [k, k + 1).
+    int32_t a, len;
+    if (op == OP_ARC) {
+      const float turns = value(l + L_LENGTH, in);
+      a = to_steps(value(l + L_START, in), n);
+      len = (int32_t) (std::min(fabsf(turns), 1.0f) * n * 256.0f);
+      if (turns < 0) a -= len;  // counter-clockwise from start
+    } else {
+      const float width = value(l + L_WIDTH, in);
+      len = (int32_t) (std::min(width, (float) n) * 256.0f);
+      a = to_steps(value(l + L_START, in), n) + 128 - len / 2;  // centred on the LED
+    }
+    if (len <= 0) return;
+
+    const int32_t b = a + len;
+    for (int32_t k = a >> 8; (k << 8) < b; k++) {
+      const int32_t lo = std::max(a, k << 8);
+      const int32_t hi = std::min(b, (k + 1) << 8);
+      if (hi <= lo) continue;
+      const uint32_t cov = hi - lo;  // 1-256
+      Color c = c0;
+      if (gradient) {
+        const int32_t t = (((k << 8) + 128 - a) << 8) / len;
+        c = lerp(c0, c1, std::max<int32_t>(0, std::min<int32_t>(256, t)));
+      }
+      const int idx = ((k % n) + n) % n;
+      put(it, ring_led(ring, idx), c, (cov * op_alpha) >> 8, blend);
+    }
+  }
+
+  void FaceProgram::run(const uint8_t *code, const FaceInputs &in, light::AddressableLight &it) {
+    for (int i = 0; i < TOTAL_LEDS; i++) it[i] = Color(0, 0, 0);
+    for (uint8_t n = 0; n < code[2]; n++) {
+      layer(code + HEADER_LEN + n * LAYER_LEN, in, it);
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
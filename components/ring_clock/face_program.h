@@ -0,0 +1,91 @@
+#pragma once
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/core/color.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Colors a face program can bind to, besides literal RGB.
+enum FaceColorSource : uint8_t {
+  FACE_COLOR_RGB = 0,
+  FACE_COLOR_HOUR = 1,
+  FACE_COLOR_MINUTE = 2,
+  FACE_COLOR_SECOND = 3,
+  FACE_COLOR_MARKER = 4,
+  FACE_COLOR_NOTIFICATION = 5,
+  FACE_COLOR_SOURCES,
+};
+
+// Per-frame inputs of a face program. Times are fractions of a turn of the
+// respective hand, continuous (the second includes the sub-second).
+struct FaceInputs {
+  float second;
+  float minute;
+  float hour;    // 12-hour dial
+  float hour24;
+  uint32_t ms;   // free-running, for `phase` bindings
+  Color colors[FACE_COLOR_SOURCES];  // [FACE_COLOR_RGB] unused
+};
+
+// Interpreter for custom faces compiled from YAML (`faces:`) by
+// __init__.py's compile_face().
+//
+// A program is a 4-byte header ('F', version, layer count, flags) and one
+// fixed LAYER_LEN record per layer, drawn in order onto a black frame:
+//
+//   u8 op (fill / arc / dot), u8 ring (inner / outer / markers),
+//   u8 blend | gradient << 4, then four values (start, length, width,
+//   opacity) and two colors (color, color_to).
+//
+// A value is u8 source, u8 easing, u16 period_ms, i16 scale, i16 offset
+// (Q12): easing(source) * scale + offset. Positions and lengths are in
+// turns (0 = 12 o'clock, clockwise), width in LEDs, opacity 0-1. A color is
+// u8 FaceColorSource and r, g, b. Coverage is computed in 1/256 LED steps,
+// so arcs and dots move smoothly between LEDs.
+class FaceProgram {
+public:
+  static constexpr uint8_t MAGIC{'F'};
+  static constexpr uint8_t VERSION{1};
+  static constexpr size_t HEADER_LEN{4};
+  static constexpr size_t LAYER_LEN{43};
+  static constexpr uint8_t FLAG_ANIMATED{0x01};  // must be drawn every frame
+
+  enum Op : uint8_t { OP_FILL = 1, OP_ARC = 2, OP_DOT = 3 };
+  enum Ring : uint8_t { RING_INNER = 0, RING_OUTER = 1, RING_MARKERS = 2 };
+  enum Blend : uint8_t { BLEND_OVER = 0, BLEND_ADD = 1, BLEND_MAX = 2 };
+  enum Source : uint8_t {
+    SRC_CONST = 0,
+    SRC_SECOND = 1,
+    SRC_MINUTE = 2,
+    SRC_HOUR = 3,
+    SRC_HOUR24 = 4,
+    SRC_PHASE = 5,
+  };
+  enum Easing : uint8_t {
+    EASE_LINEAR = 0,
+    EASE_IN = 1,
+    EASE_OUT = 2,
+    EASE_IN_OUT = 3,
+    EASE_SINE = 4,      // 0 -> 1 -> 0, smooth
+    EASE_PINGPONG = 5,  // 0 -> 1 -> 0, linear
+    EASE_STEP = 6,      // 0 for the first half, then 1
+  };
+
+  // Checks the header and length; a bad program is never run.
+  static bool validate(const uint8_t *code, size_t len);
+  static bool is_animated(const uint8_t *code) { return code[3] & FLAG_ANIMATED; }
+
+  // Clears the rings and draws every layer.
+  static void run(const uint8_t *code, const FaceInputs &in, light::AddressableLight &it);
+
+protected:
+  static float value(const uint8_t *v, const FaceInputs &in);
+  static Color color(const uint8_t *c, const FaceInputs &in);
+  static void layer(const uint8_t *l, const FaceInputs &in, light::AddressableLight &it);
+};
+
+} // namespace ring_clock
+} // namespace esphome
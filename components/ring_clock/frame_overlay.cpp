@@ -0,0 +1,201 @@
+#include "frame_overlay.h"
+#ifdef USE_RING_CLOCK_FRAME_OVERLAY
+
+#include "esphome/components/network/util.h"
+#include "esphome/core/log.h"
+#include <lwip/inet.h>
+#include <lwip/sockets.h>
+#include <cerrno>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.overlay";
+
+  // Packets handled per poll(); a 108-pixel frame is one packet in either
+  // protocol, so this only bounds a backlog after a loop() stall.
+  static const uint8_t MAX_PACKETS_PER_POLL = 8;
+
+  // DDP header: flags, seq, type, id, offset (BE u32), length (BE u16).
+  static const size_t DDP_HEADER_LEN = 10;
+  static const uint8_t DDP_VERSION_MASK = 0xC0;
+  static const uint8_t DDP_VERSION_1 = 0x40;
+  static const uint8_t DDP_TIMECODE = 0x10;
+  static const uint8_t DDP_STORAGE = 0x08;
+  static const uint8_t DDP_REPLY = 0x04;
+  static const uint8_t DDP_QUERY = 0x02;
+  static const uint8_t DDP_PUSH = 0x01;
+  static const uint8_t DDP_ID_DISPLAY = 1;
+
+  // E1.31 data packet offsets (ANSI E1.31-2018, section 4).
+  static const size_t E131_ACN_ID = 4;
+  static const size_t E131_ROOT_VECTOR = 18;
+  static const size_t E131_FRAMING_VECTOR = 40;
+  static const size_t E131_OPTIONS = 112;
+  static const size_t E131_UNIVERSE = 113;
+  static const size_t E131_DMP_VECTOR = 117;
+  static const size_t E131_PROPERTY_COUNT = 123;
+  static const size_t E131_START_CODE = 125;
+  static const size_t E131_HEADER_LEN = 126;
+  static const uint8_t E131_PREVIEW = 0x80;
+  static const uint8_t E131_TERMINATED = 0x40;
+  static const uint8_t ACN_PACKET_ID[12] = {'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0};
+
+  static inline uint16_t be16(const uint8_t *p) { return (p[0] << 8) | p[1]; }
+  static inline uint32_t be32(const uint8_t *p) {
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+  }
+
+  void FrameOverlay::configure(OverlayProtocol protocol, uint16_t port, uint16_t universe,
+                               bool rgba, uint32_t timeout_ms) {
+    _protocol = protocol;
+    _port = port;
+    _universe = universe;
+    _channels = rgba ? 4 : 3;
+    _timeout_ms = timeout_ms;
+  }
+
+  bool FrameOverlay::open_socket() {
+    _fd = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_fd < 0) {
+      ESP_LOGE(TAG, "Cannot create socket (errno %d)", errno);
+      return false;
+    }
+    int one = 1;
+    lwip_setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    lwip_fcntl(_fd, F_SETFL, lwip_fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (lwip_bind(_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+      ESP_LOGE(TAG, "Cannot bind UDP port %u (errno %d)", (unsigned) _port, errno);
+      lwip_close(_fd);
+      _fd = -1;
+      return false;
+    }
+    if (_protocol == OVERLAY_E131) {
+      // sACN senders usually multicast to 239.255.<universe hi>.<universe lo>;
+      // unicast to the clock works either way.
+      struct ip_mreq mreq {};
+      mreq.imr_multiaddr.s_addr = htonl(0xEFFF0000UL | _universe);
+      mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+      if (lwip_setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        ESP_LOGW(TAG, "Cannot join the universe %u multicast group, unicast only",
+                 (unsigned) _universe);
+      }
+    }
+    ESP_LOGI(TAG, "Listening for %s on UDP port %u", _protocol == OVERLAY_DDP ? "DDP" : "E1.31",
+             (unsigned) _port);
+    return true;
+  }
+
+  bool FrameOverlay::poll(uint32_t now_ms) {
+    if (_fd < 0) {
+      if (!network::is_connected() || !open_socket()) return false;
+    }
+    bool changed = false;
+    for (uint8_t n = 0; n < MAX_PACKETS_PER_POLL; n++) {
+      const ssize_t len = lwip_recv(_fd, _rx, sizeof(_rx), 0);
+      if (len < 0) break;  // EWOULDBLOCK: drained
+      if (_protocol == OVERLAY_DDP) {
+        changed |= on_ddp(_rx, len, now_ms);
+      } else {
+        changed |= on_e131(_rx, len, now_ms);
+      }
+    }
+    if (_active && now_ms - _last_frame_ms >= _timeout_ms) {
+      ESP_LOGD(TAG, "Overlay timed out after %u frames", (unsigned) _frames);
+      _active = false;
+      changed = true;
+    }
+    return changed;
+  }
+
+  bool FrameOverlay::on_ddp(const uint8_t *p, size_t len, uint32_t now_ms) {
+    if (len < DDP_HEADER_LEN) return false;
+    const uint8_t flags = p[0];
+    if ((flags & DDP_VERSION_MASK) != DDP_VERSION_1) return false;
+    // Queries, replies and storage writes are for full DDP displays.
+    if (flags & (DDP_QUERY | DDP_REPLY | DDP_STORAGE)) return false;
+    if (p[3] != DDP_ID_DISPLAY) return false;
+    const size_t header = DDP_HEADER_LEN + ((flags & DDP_TIMECODE) ? 4 : 0);
+    const uint32_t offset = be32(p + 4);
+    const size_t data_len = be16(p + 8);
+    if (len < header + data_len) return false;
+
+    stage(offset, p + header, data_len);
+    if (!(flags & DDP_PUSH)) return false;
+    present(now_ms);
+    return true;
+  }
+
+  bool FrameOverlay::on_e131(const uint8_t *p, size_t len, uint32_t now_ms) {
+    if (len < E131_HEADER_LEN) return false;
+    if (memcmp(p + E131_ACN_ID, ACN_PACKET_ID, sizeof(ACN_PACKET_ID)) != 0) return false;
+    if (be32(p + E131_ROOT_VECTOR) != 0x00000004UL) return false;   // VECTOR_ROOT_E131_DATA
+    if (be32(p + E131_FRAMING_VECTOR) != 0x00000002UL) return false;  // VECTOR_E131_DATA_PACKET
+    if (p[E131_DMP_VECTOR] != 0x02) return false;                     // VECTOR_DMP_SET_PROPERTY
+    if (be16(p + E131_UNIVERSE) != _universe) return false;
+
+    const uint8_t options = p[E131_OPTIONS];
+    if (options & E131_PREVIEW) return false;  // for visualisers, not fixtures
+    if (options & E131_TERMINATED) {
+      const bool was_active = _active;
+      _active = false;
+      return was_active;
+    }
+    if (p[E131_START_CODE] != 0) return false;  // only plain DMX level data
+    // The property count includes the start code.
+    const size_t count = be16(p + E131_PROPERTY_COUNT);
+    if (count < 1 || len < E131_HEADER_LEN + count - 1) return false;
+
+    stage(0, p + E131_HEADER_LEN, count - 1);
+    present(now_ms);
+    return true;
+  }
+
+  void FrameOverlay::stage(size_t offset, const uint8_t *data, size_t len) {
+    const size_t limit = (size_t) TOTAL_LEDS * _channels;
+    if (offset >= limit) return;
+    if (len > limit - offset) len = limit - offset;  // extra pixels are ignored
+    memcpy(_back + offset, data, len);
+  }
+
+  void FrameOverlay::present(uint32_t now_ms) {
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+      const uint8_t *src = _back + i * _channels;
+      uint8_t *dst = _front + i * 4;
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+      dst[3] = _channels == 4 ? src[3] : ((src[0] | src[1] | src[2]) ? 255 : 0);
+    }
+    if (!_active) ESP_LOGD(TAG, "Overlay active");
+    _active = true;
+    _last_frame_ms = now_ms;
+    _frames++;
+  }
+
+  void FrameOverlay::blend(light::AddressableLight &it) const {
+    if (!_active) return;
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+      const uint8_t *px = _front + i * 4;
+      const uint8_t a = px[3];
+      if (a == 0) continue;
+      if (a == 255) {
+        it[i] = Color(px[0], px[1], px[2]);
+        continue;
+      }
+      const Color c = it[i].get();
+      const uint16_t ia = 255 - a;
+      it[i] = Color((px[0] * a + c.r * ia) / 255, (px[1] * a + c.g * ia) / 255,
+                    (px[2] * a + c.b * ia) / 255);
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_FRAME_OVERLAY
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_FRAME_OVERLAY
+
+#include "esphome/components/light/addressable_light.h"
+#include "ring_layout.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+enum OverlayProtocol : uint8_t {
+  OVERLAY_DDP = 0,   // Distributed Display Protocol, port 4048
+  OVERLAY_E131 = 1,  // sACN / E1.31, port 5568, one universe
+};
+
+// Pixels pushed over UDP by a building system, WLED/xLights or any DDP or
+// E1.31 sender, shown on top of the clock face.
+//
+// Pixel data is laid out like the strip: R1 (0-59) then R2 (60-107). With
+// `rgba` each pixel carries a fourth channel used as alpha; with RGB,
+// black is transparent and any other colour is opaque. Packets land in a
+// back buffer and become visible when the frame is complete (DDP PUSH
+// flag, or every E1.31 packet), so a multi-packet frame never tears. All
+// buffers are members: receiving allocates nothing.
+//
+// The overlay disappears after `timeout` without a completed frame, or at
+// once on an E1.31 stream-terminated packet.
+class FrameOverlay {
+public:
+  // DDP packets carry at most 1440 data bytes; E1.31 packets are 638.
+  static constexpr size_t RX_BUFFER_LEN{1460};
+  static constexpr size_t MAX_CHANNELS{TOTAL_LEDS * 4};
+
+  void configure(OverlayProtocol protocol, uint16_t port, uint16_t universe, bool rgba,
+                 uint32_t timeout_ms);
+
+  // Opens the socket once the network is up, then drains pending packets.
+  // Returns true if the visible overlay changed (new frame, or timed out).
+  bool poll(uint32_t now_ms);
+
+  bool is_active() const { return _active; }
+  uint32_t get_frame_count() const { return _frames; }
+
+  // Alpha-blend the visible overlay onto a rendered frame.
+  void blend(light::AddressableLight &it) const;
+
+protected:
+  bool open_socket();
+  bool on_ddp(const uint8_t *p, size_t len, uint32_t now_ms);
+  bool on_e131(const uint8_t *p, size_t len, uint32_t now_ms);
+  void stage(size_t offset, const uint8_t *data, size_t len);
+  void present(uint32_t now_ms);
+
+  OverlayProtocol _protocol{OVERLAY_DDP};
+  uint16_t _port{4048};
+  uint16_t _universe{1};
+  uint8_t _channels{3};
+  uint32_t _timeout_ms{2500};
+  int _fd{-1};
+
+  uint8_t _rx[RX_BUFFER_LEN];
+  uint8_t _back[MAX_CHANNELS]{};      // as received, _channels per pixel
+  uint8_t _front[TOTAL_LEDS * 4]{};   // RGBA, what blend() shows
+  bool _active{false};
+  uint32_t _last_frame_ms{0};
+  uint32_t _frames{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_FRAME_OVERLAY
@@ -0,0 +1,68 @@
+#include "frame_preview.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  void FramePreview::capture(light::AddressableLight &it, uint32_t now_ms) {
+    // Fast path: nobody is watching.
+    if (!active(now_ms)) return;
+    if (now_ms - _last_capture_ms < _min_interval_ms) return;
+    _last_capture_ms = now_ms;
+
+    uint8_t frame[FRAME_BYTES];
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+      Color c = it[i].get();
+      frame[i * 3]     = c.r;
+      frame[i * 3 + 1] = c.g;
+      frame[i * 3 + 2] = c.b;
+    }
+
+    LockGuard guard(_lock);
+    if (memcmp(frame, _cur, FRAME_BYTES) == 0) return;  // send only on change
+    memcpy(_prev, _cur, FRAME_BYTES);
+    memcpy(_cur, frame, FRAME_BYTES);
+    _seq++;
+  }
+
+  size_t FramePreview::build_response(int32_t since, uint8_t *out, uint32_t now_ms) {
+    _last_request_ms = now_ms ? now_ms : 1;
+
+    LockGuard guard(_lock);
+    out[1] = _seq & 0xFF;
+    out[2] = _seq >> 8;
+
+    if (since == (int32_t)_seq) {
+      out[0] = 0;
+      return 3;
+    }
+
+    if (since >= 0 && (uint16_t)(since + 1) == _seq) {
+      // Delta against the frame the client already has.
+      size_t len = 3;
+      int i = 0;
+      while (i < TOTAL_LEDS) {
+        if (memcmp(_cur + i * 3, _prev + i * 3, 3) == 0) { i++; continue; }
+        int first = i;
+        while (i < TOTAL_LEDS && i - first < 255 && memcmp(_cur + i * 3, _prev + i * 3, 3) != 0) i++;
+        int count = i - first;
+        if (len + 2 + count * 3 > 3 + FRAME_BYTES) { len = 0; break; }  // keyframe is smaller
+        out[len++] = first;
+        out[len++] = count;
+        memcpy(out + len, _cur + first * 3, count * 3);
+        len += count * 3;
+      }
+      if (len != 0) {
+        out[0] = 2;
+        return len;
+      }
+    }
+
+    out[0] = 1;
+    memcpy(out + 3, _cur, FRAME_BYTES);
+    return 3 + FRAME_BYTES;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
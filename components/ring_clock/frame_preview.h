@@ -0,0 +1,60 @@
+#pragma once
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/core/helpers.h"
+#include "ring_layout.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Bytes in one RGB frame of both rings.
+#define FRAME_BYTES (TOTAL_LEDS * 3)
+
+// Largest preview response: 3-byte header + one keyframe.
+#define PREVIEW_MAX_RESPONSE (3 + FRAME_BYTES)
+
+// Live preview of what addressable_lights_lambdacall() rendered.
+//
+// The renderer hands every produced frame to capture(). While no client has
+// polled for PREVIEW_IDLE_MS that is a single millis() comparison; while a
+// client is connected, at most one frame per min_interval is copied, and
+// only if it differs from the previous one.
+//
+// Wire format (all little-endian), built by build_response():
+//   u8 type   0 = unchanged, 1 = keyframe, 2 = delta
+//   u16 seq   sequence number of the frame the client now holds
+//   keyframe: TOTAL_LEDS x RGB
+//   delta:    runs of { u8 first_led, u8 count, count x RGB } against seq-1
+class FramePreview {
+public:
+  // A client that has not polled for this long is considered gone.
+  static constexpr uint32_t PREVIEW_IDLE_MS{3000};
+
+  void set_min_interval(uint32_t ms) { _min_interval_ms = ms; }
+
+  // Called from the render path after the frame is complete.
+  void capture(light::AddressableLight &it, uint32_t now_ms);
+
+  // Called from the web handler (HTTP task). `since` is the seq the client
+  // last received, or -1 to request a keyframe. Returns the number of bytes
+  // written to out (at most PREVIEW_MAX_RESPONSE).
+  size_t build_response(int32_t since, uint8_t *out, uint32_t now_ms);
+
+protected:
+  bool active(uint32_t now_ms) const {
+    return _last_request_ms != 0 && now_ms - _last_request_ms < PREVIEW_IDLE_MS;
+  }
+
+  uint8_t _cur[FRAME_BYTES]{};
+  uint8_t _prev[FRAME_BYTES]{};
+  uint16_t _seq{0};
+  uint32_t _min_interval_ms{100};
+  uint32_t _last_capture_ms{0};
+  volatile uint32_t _last_request_ms{0};
+  Mutex _lock; // render loop vs. HTTP server task
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,54 @@
+#include "interference_map.h"
+
+#include "esphome/core/helpers.h"
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  // Bump the suffix if the table layout or units change.
+  static const char *const PREF_KEY = "ring_clock_interference_v1";
+
+  bool InterferenceMap::load() {
+    _pref = global_preferences->make_preference<Table>(fnv1_hash(PREF_KEY));
+    _valid = _pref.load(&_table) && _table.steps == TOTAL_LEDS * 3;
+    if (!_valid) memset(&_table, 0, sizeof(_table));
+    return _valid;
+  }
+
+  bool InterferenceMap::save() {
+    _table.steps = TOTAL_LEDS * 3;
+    _valid = _pref.save(&_table) && global_preferences->sync();
+    return _valid;
+  }
+
+  void InterferenceMap::clear() {
+    memset(&_table, 0, sizeof(_table));
+    _pref.save(&_table);
+    global_preferences->sync();
+    _valid = false;
+  }
+
+  void InterferenceMap::set_weight(int led, int channel, float delta_mv, uint8_t level) {
+    float w = 0.0f;
+    if (level > 0 && delta_mv > 0.0f) {
+      // Scale to full output and into 1/16 mV.
+      w = delta_mv * (255.0f / level) * (1 << WEIGHT_FRAC_BITS);
+    }
+    _table.w[led * 3 + channel] = (uint16_t) std::min(w + 0.5f, (float) WEIGHT_MAX);
+  }
+
+  float InterferenceMap::estimate_mv(light::AddressableLight &it) const {
+    if (!_valid) return 0.0f;
+    uint32_t acc = 0;
+    const uint16_t *w = _table.w;
+    for (int i = 0; i < TOTAL_LEDS; i++, w += 3) {
+      auto px = it[i];
+      acc += w[0] * px.get_red_raw() + w[1] * px.get_green_raw() + w[2] * px.get_blue_raw();
+    }
+    return acc / (255.0f * (1 << WEIGHT_FRAC_BITS));
+  }
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/core/preferences.h"
+#include "ring_layout.h"
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Per-LED, per-channel light leakage into the ambient light sensor.
+//
+// Each weight is the rise in sensor voltage, in 1/16 mV, when that one
+// channel of that one LED is driven at full output (raw 255) and everything
+// else is dark. The table is measured by the calibration routine and kept in
+// NVS. estimate_mv() is then a 324-term integer dot product of the frame as
+// transmitted (post brightness/gamma) with the table.
+class InterferenceMap {
+public:
+  // 4095/16 = 256 mV from a single channel is already implausible; the cap
+  // keeps the dot product within 32 bits (4095 * 255 * 324 < 2^32).
+  static constexpr uint16_t WEIGHT_MAX{4095};
+  static constexpr uint8_t WEIGHT_FRAC_BITS{4};
+
+  // Loads the table from NVS; returns true if a calibration was found.
+  bool load();
+  // Marks the table complete and writes it to NVS.
+  bool save();
+  // Forgets the calibration, in RAM and in NVS.
+  void clear();
+  bool is_calibrated() const { return _valid; }
+
+  // delta_mv: measured sensor rise with the channel at raw output `level`.
+  void set_weight(int led, int channel, float delta_mv, uint8_t level);
+  uint16_t get_weight(int led, int channel) const { return _table.w[led * 3 + channel]; }
+
+  // Expected sensor offset, in mV, caused by the frame currently in `it`.
+  float estimate_mv(light::AddressableLight &it) const;
+
+protected:
+  struct Table {
+    uint16_t w[TOTAL_LEDS * 3];
+    uint16_t steps; // TOTAL_LEDS * 3 once a calibration has completed
+  };
+
+  Table _table{};
+  bool _valid{false};
+  ESPPreferenceObject _pref;
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,210 @@
+#include "json_scanner.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+  void JsonScanner::begin(const char *const *paths, uint8_t count) {
+    _paths = paths;
+    _count = count < MAX_FIELDS ? count : MAX_FIELDS;
+    _found = 0;
+    memset(_values, 0, sizeof(_values));
+    _mode = EXPECT_VALUE;
+    _depth = 0;
+    _target = -1;
+  }
+
+  bool JsonScanner::feed(const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      const char c = data[i];
+      switch (_mode) {
+        case EXPECT_VALUE:
+          if (is_space(c)) break;
+          if (c == '{') {
+            if (!push(false)) return false;
+            _mode = EXPECT_KEY;
+          } else if (c == '[') {
+            if (!push(true)) return false;
+          } else if (c == ']' && _depth > 0 && _stack[_depth - 1].array) {
+            if (!close(true)) return false;  // empty array
+          } else if (c == '"') {
+            begin_scalar();
+            _mode = IN_STRING;
+          } else {
+            begin_scalar();
+            append(c);
+            _mode = IN_LITERAL;
+          }
+          break;
+
+        case EXPECT_KEY:
+          if (is_space(c)) break;
+          if (c == '"') {
+            _in_key = true;
+            _key_len = 0;
+            _stack[_depth - 1].key[0] = '\0';
+            _mode = IN_STRING;
+          } else if (c == '}') {
+            if (!close(false)) return false;  // empty object
+          } else {
+            _mode = FAILED;
+            return false;
+          }
+          break;
+
+        case EXPECT_COLON:
+          if (is_space(c)) break;
+          if (c != ':') {
+            _mode = FAILED;
+            return false;
+          }
+          _mode = EXPECT_VALUE;
+          break;
+
+        case IN_STRING:
+          if (c == '\\') {
+            _mode = IN_ESCAPE;
+          } else if (c == '"') {
+            if (_in_key) {
+              _mode = EXPECT_COLON;
+            } else {
+              end_scalar();
+            }
+          } else {
+            append(c);
+          }
+          break;
+
+        case IN_ESCAPE:
+          // \uXXXX is kept as written; the fields of interest are ASCII.
+          switch (c) {
+            case 'n': append('\n'); break;
+            case 't': append('\t'); break;
+            case 'r': append('\r'); break;
+            case 'b': append('\b'); break;
+            case 'f': append('\f'); break;
+            case 'u': append('\\'); append('u'); break;
+            default: append(c); break;
+          }
+          _mode = IN_STRING;
+          break;
+
+        case IN_LITERAL:
+          if (!is_space(c) && c != ',' && c != '}' && c != ']') {
+            append(c);
+            break;
+          }
+          end_scalar();
+          i--;  // the delimiter belongs to the enclosing container
+          break;
+
+        case AFTER_VALUE:
+          if (is_space(c)) break;
+          if (_depth == 0) {
+            _mode = FAILED;
+            return false;
+          }
+          if (c == ',') {
+            Level &top = _stack[_depth - 1];
+            if (top.array) {
+              top.index++;
+              _mode = EXPECT_VALUE;
+            } else {
+              _mode = EXPECT_KEY;
+            }
+          } else if (c == '}' || c == ']') {
+            if (!close(c == ']')) return false;
+          } else {
+            _mode = FAILED;
+            return false;
+          }
+          break;
+
+        case FINISHED:
+          break;  // trailing bytes after the document
+
+        case FAILED:
+          return false;
+      }
+    }
+    return _mode != FAILED;
+  }
+
+  bool JsonScanner::push(bool array) {
+    if (_depth >= MAX_DEPTH) {
+      _mode = FAILED;
+      return false;
+    }
+    Level &l = _stack[_depth++];
+    l.array = array;
+    l.index = 0;
+    l.key[0] = '\0';
+    _mode = EXPECT_VALUE;
+    return true;
+  }
+
+  bool JsonScanner::close(bool array) {
+    if (_depth == 0 || _stack[_depth - 1].array != array) {
+      _mode = FAILED;
+      return false;
+    }
+    _depth--;
+    _mode = _depth == 0 ? FINISHED : AFTER_VALUE;
+    return true;
+  }
+
+  void JsonScanner::begin_scalar() {
+    _in_key = false;
+    _target = match_path();
+    _value_len = 0;
+  }
+
+  void JsonScanner::append(char c) {
+    if (_in_key) {
+      if ((size_t) _key_len + 1 < MAX_KEY) {
+        char *key = _stack[_depth - 1].key;
+        key[_key_len++] = c;
+        key[_key_len] = '\0';
+      }
+      return;
+    }
+    if (_target < 0 || (size_t) _value_len + 1 >= MAX_VALUE) return;
+    _values[_target][_value_len++] = c;
+    _values[_target][_value_len] = '\0';
+  }
+
+  void JsonScanner::end_scalar() {
+    if (_target >= 0) _found |= 1 << _target;
+    _target = -1;
+    _mode = _depth == 0 ? FINISHED : AFTER_VALUE;
+  }
+
+  int8_t JsonScanner::match_path() const {
+    if (_count == 0 || _depth == 0) return -1;
+    // Dotted path of the value about to start.
+    char path[MAX_DEPTH * (MAX_KEY + 1)];
+    size_t n = 0;
+    for (uint8_t d = 0; d < _depth; d++) {
+      const Level &l = _stack[d];
+      if (d > 0) path[n++] = '.';
+      if (l.array) {
+        n += snprintf(path + n, sizeof(path) - n, "%u", (unsigned) l.index);
+      } else {
+        const size_t k = strlen(l.key);
+        memcpy(path + n, l.key, k);
+        n += k;
+      }
+    }
+    path[n] = '\0';
+    for (uint8_t i = 0; i < _count; i++) {
+      if (!is_found(i) && strcmp(path, _paths[i]) == 0) return i;
+    }
+    return -1;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
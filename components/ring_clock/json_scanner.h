@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Streaming extractor for a few scalar fields of a JSON document.
+//
+// Bytes are fed in arbitrary chunks as they arrive; no tree is built and
+// memory is fixed: a container stack of MAX_DEPTH levels and one
+// MAX_VALUE-byte slot per requested field. Fields are dotted paths with
+// array indices as numbers, e.g. "timezone.id" or "builds.0.ota.md5".
+// Values are stored as text (strings unescaped, numbers and literals as
+// written) and truncated to fit. Keys longer than MAX_KEY are truncated too,
+// so very long keys can only match their first MAX_KEY - 1 bytes.
+class JsonScanner {
+public:
+  static constexpr uint8_t MAX_FIELDS{4};
+  static constexpr uint8_t MAX_DEPTH{8};
+  static constexpr size_t MAX_KEY{24};
+  static constexpr size_t MAX_VALUE{64};
+
+  // `paths` must outlive the scan.
+  void begin(const char *const *paths, uint8_t count);
+  // Returns false once the input is malformed; further data is ignored.
+  bool feed(const char *data, size_t len);
+
+  bool is_found(uint8_t i) const { return (_found >> i) & 1; }
+  bool all_found() const { return _found == (1u << _count) - 1; }
+  const char *get_value(uint8_t i) const { return _values[i]; }
+
+protected:
+  enum Mode : uint8_t {
+    EXPECT_VALUE,
+    EXPECT_KEY,
+    EXPECT_COLON,
+    IN_STRING,
+    IN_ESCAPE,
+    IN_LITERAL,
+    AFTER_VALUE,
+    FINISHED,
+    FAILED,
+  };
+  struct Level {
+    bool array;
+    uint16_t index;
+    char key[MAX_KEY];
+  };
+
+  bool push(bool array);
+  void begin_scalar();
+  void append(char c);
+  void end_scalar();
+  bool close(bool array);
+  int8_t match_path() const;
+
+  const char *const *_paths{nullptr};
+  uint8_t _count{0};
+  uint8_t _found{0};
+  char _values[MAX_FIELDS][MAX_VALUE]{};
+
+  Mode _mode{EXPECT_VALUE};
+  Level _stack[MAX_DEPTH];
+  uint8_t _depth{0};
+  bool _in_key{false};
+  uint8_t _key_len{0};
+  int8_t _target{-1};  // field the current scalar is captured into
+  uint8_t _value_len{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Stopwatch lap splits in a fixed ring.
+//
+// Each entry keeps the split (stopwatch time at the lap) and the lap time
+// (since the previous split, or since zero for the first lap), so the oldest
+// entries can be dropped once MAX_LAPS are held without losing the lap times
+// of the ones kept. Lap numbers keep counting past MAX_LAPS.
+class LapRing {
+public:
+  static constexpr uint8_t MAX_LAPS{32};
+
+  struct Lap {
+    uint16_t number;  // 1-based
+    uint32_t split_ms;
+    uint32_t lap_ms;
+  };
+
+  void clear() {
+    _total = 0;
+    _best_ms = 0;
+  }
+
+  // Records a lap at stopwatch time split_ms; returns it.
+  const Lap &add(uint32_t split_ms) {
+    const uint32_t prev = _total > 0 ? get(0).split_ms : 0;
+    Lap &l = _laps[_total % MAX_LAPS];
+    l.number = _total < UINT16_MAX ? _total + 1 : UINT16_MAX;
+    l.split_ms = split_ms;
+    l.lap_ms = split_ms - prev;
+    if (_total == 0 || l.lap_ms < _best_ms) _best_ms = l.lap_ms;
+    if (_total < UINT16_MAX) _total++;
+    return l;
+  }
+
+  uint16_t total() const { return _total; }
+  uint8_t size() const { return _total < MAX_LAPS ? _total : MAX_LAPS; }
+  // back = 0 is the newest lap; back must be below size().
+  const Lap &get(uint8_t back) const { return _laps[(_total - 1 - back) % MAX_LAPS]; }
+  // Shortest lap since clear(), including laps no longer held.
+  uint32_t best_ms() const { return _best_ms; }
+
+protected:
+  Lap _laps[MAX_LAPS]{};
+  uint16_t _total{0};
+  uint32_t _best_ms{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
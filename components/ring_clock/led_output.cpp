@@ -0,0 +1,134 @@
+#include "led_output.h"
+#ifdef USE_RING_CLOCK_LED_OUTPUT
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <cinttypes>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.led";
+
+  // Pixel and symbol buffers must stay reachable from the RMT interrupt.
+  static const uint32_t INTERNAL_CAPS = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+
+  static inline uint16_t ns_to_ticks(uint32_t ns) {
+    return (uint16_t) ((ns * (uint64_t) RingClockLedOutput::RMT_RESOLUTION_HZ + 500000000) / 1000000000);
+  }
+
+  void RingClockLedOutput::set_led_params(uint32_t bit0_high, uint32_t bit0_low, uint32_t bit1_high,
+                                          uint32_t bit1_low, uint32_t reset_us) {
+    _encoder.set_timing(ns_to_ticks(bit0_high), ns_to_ticks(bit0_low), ns_to_ticks(bit1_high),
+                        ns_to_ticks(bit1_low));
+    _reset_ticks = reset_us * (RMT_RESOLUTION_HZ / 1000000);
+  }
+
+  void RingClockLedOutput::setup() {
+    const size_t bytes = _num_leds * BYTES_PER_LED;
+    _symbol_count = bytes * SymbolEncoder::SYMBOLS_PER_BYTE + 1;
+    _buf = (uint8_t *) heap_caps_calloc(bytes, 1, INTERNAL_CAPS);
+    _shadow = (uint8_t *) heap_caps_calloc(bytes, 1, INTERNAL_CAPS);
+    _effect_data = (uint8_t *) heap_caps_calloc(_num_leds, 1, INTERNAL_CAPS);
+    _symbols = (uint32_t *) heap_caps_malloc(_symbol_count * sizeof(uint32_t), INTERNAL_CAPS);
+    if (_buf == nullptr || _shadow == nullptr || _effect_data == nullptr || _symbols == nullptr) {
+      ESP_LOGE(TAG, "Cannot allocate LED buffers (%u bytes)", (unsigned) (_symbol_count * sizeof(uint32_t)));
+      this->mark_failed();
+      return;
+    }
+    _encoder.encode_all(_buf, _shadow, _symbols, _num_leds, BYTES_PER_LED);
+    _symbols[_symbol_count - 1] = SymbolEncoder::reset_symbol(_reset_ticks);
+
+    rmt_tx_channel_config_t channel{};
+    channel.clk_src = RMT_CLK_SRC_DEFAULT;
+    channel.resolution_hz = RMT_RESOLUTION_HZ;
+    channel.gpio_num = gpio_num_t(_pin);
+    channel.mem_block_symbols = _rmt_symbols;
+    channel.trans_queue_depth = 1;
+    rmt_copy_encoder_config_t encoder{};
+    rmt_tx_event_callbacks_t callbacks{};
+    callbacks.on_trans_done = &RingClockLedOutput::on_tx_done;
+    if (rmt_new_tx_channel(&channel, &_channel) != ESP_OK
+        || rmt_new_copy_encoder(&encoder, &_copy_encoder) != ESP_OK
+        || rmt_tx_register_event_callbacks(_channel, &callbacks, this) != ESP_OK
+        || rmt_enable(_channel) != ESP_OK) {
+      ESP_LOGE(TAG, "Cannot set up the RMT channel on GPIO%u", _pin);
+      this->mark_failed();
+      return;
+    }
+    _last_publish_ms = millis();
+    ESP_LOGI(TAG, "%u LEDs on GPIO%u, %u bytes of symbols", _num_leds, _pin,
+             (unsigned) (_symbol_count * sizeof(uint32_t)));
+  }
+
+  IRAM_ATTR bool RingClockLedOutput::on_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                                                void *arg) {
+    static_cast<RingClockLedOutput *>(arg)->_tx_done_us = (uint32_t) esp_timer_get_time();
+    return false;
+  }
+
+  void RingClockLedOutput::write_state(light::LightState *state) {
+    const uint32_t now = micros();
+    if (_max_refresh_us != 0 && now - _last_refresh_us < _max_refresh_us) {
+      this->schedule_show();
+      return;
+    }
+    // The interrupt reads the symbols until the previous frame is out. A frame
+    // takes about 3 ms; rather than block the loop, try again next loop.
+    if (rmt_tx_wait_all_done(_channel, TX_WAIT_MS) != ESP_OK) {
+      if (now - _tx_start_us > TX_STUCK_US && !this->status_has_warning()) {
+        ESP_LOGE(TAG, "RMT TX timeout");
+        this->status_set_warning();
+      }
+      this->schedule_show();
+      return;
+    }
+    _last_refresh_us = now;
+    this->mark_shown_();
+    if (_tx_timed) {
+      const uint32_t tx_us = _tx_done_us - _tx_start_us;
+      if (tx_us > _window_tx_us) _window_tx_us = tx_us;
+      _tx_timed = false;
+    }
+
+    const uint32_t start_us = (uint32_t) esp_timer_get_time();
+    const size_t changed = _encoder.update(_buf, _shadow, _symbols, _num_leds, BYTES_PER_LED);
+    const uint32_t encode_us = (uint32_t) esp_timer_get_time() - start_us;
+    if (encode_us > _window_encode_us) _window_encode_us = encode_us;
+    // The strip keeps showing the last frame.
+    if (changed == 0 && _sent_once) return;
+    ESP_LOGVV(TAG, "%u pixels re-encoded in %" PRIu32 " us", (unsigned) changed, encode_us);
+
+    rmt_transmit_config_t config{};
+    _tx_start_us = (uint32_t) esp_timer_get_time();
+    if (rmt_transmit(_channel, _copy_encoder, _symbols, _symbol_count * sizeof(uint32_t), &config) != ESP_OK) {
+      ESP_LOGE(TAG, "RMT transmit failed");
+      this->status_set_warning();
+      return;
+    }
+    _tx_timed = true;
+    _sent_once = true;
+    this->status_clear_warning();
+  }
+
+  void RingClockLedOutput::loop() {
+    const uint32_t now = millis();
+    if (now - _last_publish_ms < _publish_ms) return;
+    _last_publish_ms = now;
+    if (_encode_sensor != nullptr) _encode_sensor->publish_state(_window_encode_us / 1000.0f);
+    if (_transmit_sensor != nullptr) _transmit_sensor->publish_state(_window_tx_us / 1000.0f);
+    _window_encode_us = 0;
+    _window_tx_us = 0;
+  }
+
+  light::ESPColorView RingClockLedOutput::get_view_internal(int32_t index) const {
+    uint8_t *p = _buf + index * BYTES_PER_LED;
+    return {p + _offsets[0], p + _offsets[1], p + _offsets[2], nullptr, &_effect_data[index], &this->correction_};
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_LED_OUTPUT
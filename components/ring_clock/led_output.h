@@ -0,0 +1,107 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_LED_OUTPUT
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/core/component.h"
+#include "symbol_encoder.h"
+#include <driver/rmt_tx.h>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// RMT output for the rings (`light: platform: ring_clock`), a drop-in for
+// esp32_rmt_led_strip on RGB strips.
+//
+// esp32_rmt_led_strip turns pixel bytes into RMT symbols inside the RMT
+// interrupt, every frame, for every pixel. Here the symbols of every pixel
+// are kept in RAM (32 bytes per byte of pixel data, about 10 KB for the
+// rings) and only the pixels whose bytes changed since the last frame are
+// re-encoded, in write_state() on the main loop. The interrupt just copies
+// finished symbols into RMT memory, and a frame with no changed pixel is not
+// sent at all.
+class RingClockLedOutput : public light::AddressableLight {
+public:
+  static constexpr uint32_t RMT_RESOLUTION_HZ{10000000};  // 100 ns ticks
+  static constexpr uint8_t BYTES_PER_LED{3};
+  static constexpr uint32_t TX_WAIT_MS{1};         // per write_state() call
+  static constexpr uint32_t TX_STUCK_US{1000000};  // then the channel is reported
+
+  void setup() override;
+  void loop() override;
+  float get_setup_priority() const override { return setup_priority::HARDWARE; }
+
+  void write_state(light::LightState *state) override;
+  int32_t size() const override { return this->_num_leds; }
+  light::LightTraits get_traits() override {
+    auto traits = light::LightTraits();
+    traits.set_supported_color_modes({light::ColorMode::RGB});
+    return traits;
+  }
+  void clear_effect_data() override {
+    for (uint16_t i = 0; i < this->_num_leds; i++) this->_effect_data[i] = 0;
+  }
+
+  void set_pin(uint8_t pin) { this->_pin = pin; }
+  void set_num_leds(uint16_t num_leds) { this->_num_leds = num_leds; }
+  // Position of red, green and blue in each pixel's bytes on the wire.
+  void set_rgb_offsets(uint8_t r, uint8_t g, uint8_t b) {
+    this->_offsets[0] = r;
+    this->_offsets[1] = g;
+    this->_offsets[2] = b;
+  }
+  void set_max_refresh_rate(uint32_t interval_us) { this->_max_refresh_us = interval_us; }
+  void set_rmt_symbols(uint32_t symbols) { this->_rmt_symbols = symbols; }
+  // Chipset bit timings in ns and the latch gap in us.
+  void set_led_params(uint32_t bit0_high, uint32_t bit0_low, uint32_t bit1_high, uint32_t bit1_low,
+                      uint32_t reset_us);
+
+  // Worst encode and transmit time per publish interval.
+  void set_publish_interval(uint32_t ms) { this->_publish_ms = ms; }
+  void set_encode_time_sensor(sensor::Sensor *s) { this->_encode_sensor = s; }
+  void set_transmit_time_sensor(sensor::Sensor *s) { this->_transmit_sensor = s; }
+
+protected:
+  light::ESPColorView get_view_internal(int32_t index) const override;
+  static bool on_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *arg);
+
+  uint8_t _pin{0};
+  uint16_t _num_leds{0};
+  uint8_t _offsets[3]{1, 0, 2};  // GRB
+  uint32_t _max_refresh_us{0};
+  uint32_t _rmt_symbols{48};
+  uint32_t _reset_ticks{3000};
+
+  uint8_t *_buf{nullptr};     // corrected pixel bytes, wire order
+  uint8_t *_shadow{nullptr};  // bytes behind the current symbols
+  uint8_t *_effect_data{nullptr};
+  uint32_t *_symbols{nullptr};  // data symbols, then one reset symbol
+  size_t _symbol_count{0};
+  SymbolEncoder _encoder;
+
+  rmt_channel_handle_t _channel{nullptr};
+  rmt_encoder_handle_t _copy_encoder{nullptr};
+  uint32_t _last_refresh_us{0};
+  bool _sent_once{false};
+
+  // Transmit timing: start from write_state(), end from the RMT interrupt.
+  // Read only after rmt_tx_wait_all_done(), so no locking is needed.
+  uint32_t _tx_start_us{0};
+  volatile uint32_t _tx_done_us{0};
+  bool _tx_timed{false};  // a frame went out whose time is not counted yet
+
+  uint32_t _publish_ms{60000};
+  uint32_t _last_publish_ms{0};
+  uint32_t _window_encode_us{0};
+  uint32_t _window_tx_us{0};
+  sensor::Sensor *_encode_sensor{nullptr};
+  sensor::Sensor *_transmit_sensor{nullptr};
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_LED_OUTPUT
@@ -0,0 +1,99 @@
+from dataclasses import dataclass
+
+import esphome.config_validation as cv
+import esphome.codegen as cg
+from esphome import pins
+from esphome.components import light, sensor
+from esphome.const import (
+    CONF_CHIPSET,
+    CONF_MAX_REFRESH_RATE,
+    CONF_NUM_LEDS,
+    CONF_OUTPUT_ID,
+    CONF_PIN,
+    CONF_RGB_ORDER,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_MILLISECOND,
+)
+
+from . import ns
+
+DEPENDENCIES = ["esp32"]
+AUTO_LOAD = ["sensor"]
+
+CONF_RMT_SYMBOLS = "rmt_symbols"
+CONF_ENCODE_TIME = "encode_time"
+CONF_TRANSMIT_TIME = "transmit_time"
+CONF_PUBLISH_INTERVAL = "publish_interval"
+
+RingClockLedOutput = ns.class_("RingClockLedOutput", light.AddressableLight)
+
+
+@dataclass
+class LedTimings:
+    bit0_high: int  # ns
+    bit0_low: int
+    bit1_high: int
+    bit1_low: int
+    reset_us: int
+
+
+# Same timings as esp32_rmt_led_strip, with a latch gap long enough for
+# current WS2812B revisions.
+CHIPSETS = {
+    "WS2811": LedTimings(300, 1090, 1090, 320, 300),
+    "WS2812": LedTimings(400, 1000, 1000, 400, 300),
+    "SK6812": LedTimings(300, 900, 600, 600, 300),
+    "SM16703": LedTimings(300, 900, 900, 300, 300),
+}
+RGB_ORDERS = ["RGB", "RBG", "GRB", "GBR", "BGR", "BRG"]
+
+CONFIG_SCHEMA = light.ADDRESSABLE_LIGHT_SCHEMA.extend({
+    cv.GenerateID(CONF_OUTPUT_ID): cv.declare_id(RingClockLedOutput),
+    cv.Required(CONF_PIN): pins.internal_gpio_output_pin_number,
+    cv.Required(CONF_NUM_LEDS): cv.int_range(min=1, max=1024),
+    cv.Required(CONF_RGB_ORDER): cv.one_of(*RGB_ORDERS, upper=True),
+    cv.Optional(CONF_CHIPSET, default="WS2812"): cv.one_of(*CHIPSETS, upper=True),
+    cv.Optional(CONF_MAX_REFRESH_RATE): cv.positive_time_period_microseconds,
+    cv.Optional(CONF_RMT_SYMBOLS, default=48): cv.int_range(min=48),
+    # Worst encode / transmit time per publish interval
+    cv.Optional(CONF_PUBLISH_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+    cv.Optional(CONF_ENCODE_TIME): sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        icon="mdi:timer-cog-outline",
+        accuracy_decimals=3,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+    cv.Optional(CONF_TRANSMIT_TIME): sensor.sensor_schema(
+        unit_of_measurement=UNIT_MILLISECOND,
+        icon="mdi:led-strip-variant",
+        accuracy_decimals=3,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+    ),
+}).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    cg.add_define("USE_RING_CLOCK_LED_OUTPUT")
+    var = cg.new_Pvariable(config[CONF_OUTPUT_ID])
+    await light.register_light(var, config)
+    await cg.register_component(var, config)
+
+    order = config[CONF_RGB_ORDER]
+    cg.add(var.set_pin(config[CONF_PIN]))
+    cg.add(var.set_num_leds(config[CONF_NUM_LEDS]))
+    cg.add(var.set_rgb_offsets(order.index("R"), order.index("G"), order.index("B")))
+    cg.add(var.set_rmt_symbols(config[CONF_RMT_SYMBOLS]))
+    if CONF_MAX_REFRESH_RATE in config:
+        cg.add(var.set_max_refresh_rate(config[CONF_MAX_REFRESH_RATE]))
+    t = CHIPSETS[config[CONF_CHIPSET]]
+    cg.add(var.set_led_params(t.bit0_high, t.bit0_low, t.bit1_high, t.bit1_low, t.reset_us))
+
+    cg.add(var.set_publish_interval(config[CONF_PUBLISH_INTERVAL]))
+    for key, setter in ((CONF_ENCODE_TIME, var.set_encode_time_sensor),
+                        (CONF_TRANSMIT_TIME, var.set_transmit_time_sensor)):
+        if key in config:
+            sens = await sensor.new_sensor(config[key])
+            cg.add(setter(sens))
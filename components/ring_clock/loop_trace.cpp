@@ -0,0 +1,185 @@
+#include "loop_trace.h"
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+
+#include "esphome/core/application.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.trace";
+
+  void LoopTracer::start() {
+    if (_timer != nullptr) return;
+    _loop_task = xTaskGetCurrentTaskHandle();
+    esp_timer_create_args_t args{};
+    args.callback = &LoopTracer::sample_cb;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "ring_clock_trace";
+    args.skip_unhandled_events = true;
+    if (esp_timer_create(&args, &_timer) != ESP_OK || esp_timer_start_periodic(_timer, _sample_us) != ESP_OK) {
+      ESP_LOGE(TAG, "Cannot start the loop tracer");
+      _timer = nullptr;
+      return;
+    }
+    ESP_LOGI(TAG, "Sampling the main loop every %" PRIu32 " us", _sample_us);
+  }
+
+  void LoopTracer::sample_cb(void *arg) { static_cast<LoopTracer *>(arg)->sample(); }
+
+  void LoopTracer::sample() {
+    const eTaskState st = eTaskGetState(_loop_task);
+    const bool busy = st == eRunning || st == eReady;
+    Component *c = busy ? App.get_current_component() : nullptr;
+    const int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&_mux);
+    _window_samples++;
+    if (busy) _window_busy++;
+    if (c != _run_comp) {
+      close_run();
+      _run_comp = c;
+      _run_start_us = now_us;
+    }
+    _run_last_us = now_us;
+    portEXIT_CRITICAL(&_mux);
+  }
+
+  // Called with _mux held.
+  void LoopTracer::close_run() {
+    if (_run_comp == nullptr) return;
+    // Started up to one period before its first sample, ended up to one
+    // after its last: count one period for the edges.
+    const uint32_t dur_us = (uint32_t) (_run_last_us - _run_start_us) + _sample_us;
+    const uint8_t slot = slot_for(_run_comp);
+    Slot &s = _slots[slot];
+    s.runs++;
+    s.total_us += dur_us;
+    if (dur_us > s.max_us) s.max_us = dur_us;
+    if (dur_us > s.window_max_us) s.window_max_us = dur_us;
+    if (dur_us > _gap_worst_us) {
+      _gap_worst_us = dur_us;
+      _gap_worst_slot = slot;
+    }
+    if (dur_us >= _stall_us) push_event(TRACE_STALL, dur_us, slot);
+    _run_comp = nullptr;
+  }
+
+  // Called with _mux held.
+  uint8_t LoopTracer::slot_for(Component *c) {
+    for (uint8_t i = 0; i < _slot_count; i++) {
+      if (_slots[i].comp == c) return i;
+    }
+    if (_slot_count == MAX_SLOTS) return OTHER_SLOT;
+    _slots[_slot_count].comp = c;
+    return _slot_count++;
+  }
+
+  // Called with _mux held.
+  void LoopTracer::push_event(TraceEventKind kind, uint32_t dur_us, uint8_t slot) {
+    TraceEvent &e = _events[_event_head];
+    e.t_ms = millis();
+    e.dur_us = dur_us;
+    e.slot = slot;
+    e.kind = kind;
+    _event_head = (_event_head + 1) % EVENT_COUNT;
+    if (_event_total < UINT16_MAX) _event_total++;
+  }
+
+  void LoopTracer::note_frame(bool continuing) {
+    if (_timer == nullptr) return;
+    const int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&_mux);
+    if (continuing && _last_frame_us != 0) {
+      const uint32_t gap_us = (uint32_t) (now_us - _last_frame_us);
+      if (gap_us > _window_gap_us) _window_gap_us = gap_us;
+      if (gap_us >= _gap_us) {
+        // The stall may have ended less than a sample ago, before the
+        // sampler closed its run.
+        uint8_t culprit = _gap_worst_slot;
+        if (_run_comp != nullptr
+            && (uint32_t) (_run_last_us - _run_start_us) + _sample_us > _gap_worst_us) {
+          culprit = slot_for(_run_comp);
+        }
+        push_event(TRACE_FRAME_GAP, gap_us, culprit);
+      }
+    }
+    _last_frame_us = now_us;
+    _gap_worst_us = 0;
+    _gap_worst_slot = NO_SLOT;
+    portEXIT_CRITICAL(&_mux);
+  }
+
+  const char *LoopTracer::slot_name(const Slot &s) {
+    return s.comp != nullptr ? s.comp->get_component_source() : "other";
+  }
+
+  void LoopTracer::take_window(TraceWindow *out) {
+    portENTER_CRITICAL(&_mux);
+    const Slot *worst = nullptr;
+    for (uint8_t i = 0; i <= MAX_SLOTS; i++) {
+      Slot &s = _slots[i];
+      if (s.window_max_us > 0 && (worst == nullptr || s.window_max_us > worst->window_max_us)) worst = &s;
+    }
+    out->worst_name = worst != nullptr ? slot_name(*worst) : nullptr;
+    out->worst_ms = worst != nullptr ? worst->window_max_us / 1000.0f : 0.0f;
+    out->frame_gap_ms = _window_gap_us / 1000.0f;
+    out->load_pct = _window_samples > 0 ? 100.0f * _window_busy / _window_samples : 0.0f;
+    for (auto &s : _slots) s.window_max_us = 0;
+    _window_gap_us = 0;
+    _window_samples = 0;
+    _window_busy = 0;
+    portEXIT_CRITICAL(&_mux);
+  }
+
+  std::string LoopTracer::dump() const {
+    // Snapshot first; formatting must not run inside the critical section.
+    Slot slots[MAX_SLOTS + 1];
+    TraceEvent events[EVENT_COUNT];
+    uint8_t head;
+    uint16_t total;
+    portENTER_CRITICAL(&_mux);
+    memcpy(slots, _slots, sizeof(slots));
+    memcpy(events, _events, sizeof(events));
+    head = _event_head;
+    total = _event_total;
+    portEXIT_CRITICAL(&_mux);
+
+    auto name = [&](uint8_t slot) { return slot == NO_SLOT ? "" : slot_name(slots[slot]); };
+    std::string out;
+    out.reserve(4096);
+    char buf[128];
+    snprintf(buf, sizeof(buf), "{\"uptime_ms\":%" PRIu32 ",\"sample_us\":%" PRIu32 ",\"components\":[",
+             millis(), _sample_us);
+    out += buf;
+    bool first = true;
+    for (const Slot &s : slots) {
+      if (s.runs == 0) continue;
+      snprintf(buf, sizeof(buf), "%s{\"name\":\"%s\",\"runs\":%" PRIu32 ",\"total_ms\":%" PRIu64 ",\"max_ms\":%.1f}",
+               first ? "" : ",", slot_name(s), s.runs, s.total_us / 1000, s.max_us / 1000.0f);
+      out += buf;
+      first = false;
+    }
+    out += "],\"events\":[";
+    // Oldest first.
+    const uint8_t n = total < EVENT_COUNT ? total : EVENT_COUNT;
+    for (uint8_t i = 0; i < n; i++) {
+      const TraceEvent &e = events[(head + EVENT_COUNT - n + i) % EVENT_COUNT];
+      snprintf(buf, sizeof(buf), "%s{\"t_ms\":%" PRIu32 ",\"kind\":\"%s\",\"ms\":%.1f,\"component\":\"%s\"}",
+               i == 0 ? "" : ",", e.t_ms, e.kind == TRACE_STALL ? "stall" : "frame_gap", e.dur_us / 1000.0f,
+               name(e.slot));
+      out += buf;
+    }
+    out += "]}";
+    return out;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_LOOP_TRACE
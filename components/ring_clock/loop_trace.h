@@ -0,0 +1,124 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+
+#include "esphome/core/component.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+namespace ring_clock {
+
+enum TraceEventKind : uint8_t {
+  TRACE_STALL = 0,      // one component ran for at least stall_threshold
+  TRACE_FRAME_GAP = 1,  // no LED frame for at least gap_threshold
+};
+
+struct TraceEvent {
+  uint32_t t_ms;    // millis() at the end of the stall or gap
+  uint32_t dur_us;
+  uint8_t slot;     // component (for a gap: the longest run inside it)
+  TraceEventKind kind;
+};
+
+// Worst offenders over one publish window, see take_window().
+struct TraceWindow {
+  const char *worst_name;  // nullptr if nothing ran long enough to be seen
+  float worst_ms;          // longest single run of worst_name
+  float frame_gap_ms;      // longest gap between LED frames
+  float load_pct;          // share of samples with the loop task busy
+};
+
+// Sampling profiler for the main loop, attributed per component.
+//
+// An esp_timer callback wakes every sample_us and records which component
+// the loop task is inside (App.get_current_component()), or that the loop
+// task is idle. Consecutive samples of the same component form one run; its
+// length is accurate to one sample period, so runs shorter than that are
+// mostly invisible, which is fine for finding stalls. loop(), update() and
+// other scheduled callbacks of a component share the marker and are counted
+// together. Time the loop task spends preempted by WiFi or the HTTP server
+// is charged to the component it interrupted.
+//
+// Memory is fixed: MAX_SLOTS component slots (the rest are charged to one
+// overflow slot) and a ring of EVENT_COUNT stall/gap events.
+class LoopTracer {
+public:
+  static constexpr uint8_t MAX_SLOTS{24};
+  static constexpr uint8_t OTHER_SLOT{MAX_SLOTS};  // overflow
+  static constexpr uint8_t NO_SLOT{0xFF};
+  static constexpr uint8_t EVENT_COUNT{64};
+
+  void configure(uint32_t sample_us, uint32_t stall_ms, uint32_t gap_ms) {
+    _sample_us = sample_us;
+    _stall_us = stall_ms * 1000;
+    _gap_us = gap_ms * 1000;
+  }
+  float get_stall_threshold_ms() const { return _stall_us / 1000.0f; }
+  float get_gap_threshold_ms() const { return _gap_us / 1000.0f; }
+  // From setup(): samples the task it is called on.
+  void start();
+  bool is_running() const { return _timer != nullptr; }
+
+  // From the effect lambda, on every call. `continuing` is false for the
+  // first frame after the effect was stopped, which starts no gap.
+  void note_frame(bool continuing);
+
+  // Worst offenders since the previous call; resets the window.
+  void take_window(TraceWindow *out);
+
+  // JSON dump of the per-component totals since boot and the event ring.
+  std::string dump() const;
+
+protected:
+  struct Slot {
+    Component *comp;
+    uint32_t runs;
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t window_max_us;
+  };
+
+  static void sample_cb(void *arg);
+  void sample();
+  void close_run();
+  uint8_t slot_for(Component *c);
+  void push_event(TraceEventKind kind, uint32_t dur_us, uint8_t slot);
+  static const char *slot_name(const Slot &s);
+
+  uint32_t _sample_us{2000};
+  uint32_t _stall_us{20000};
+  uint32_t _gap_us{100000};
+  esp_timer_handle_t _timer{nullptr};
+  TaskHandle_t _loop_task{nullptr};
+
+  // Written by the esp_timer task, read by loop() and the HTTP task.
+  mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  Slot _slots[MAX_SLOTS + 1]{};
+  uint8_t _slot_count{0};
+  TraceEvent _events[EVENT_COUNT]{};
+  uint8_t _event_head{0};
+  uint16_t _event_total{0};  // saturates; only "full or not" matters
+
+  // Run in progress.
+  Component *_run_comp{nullptr};
+  int64_t _run_start_us{0};
+  int64_t _run_last_us{0};
+
+  // Frame gaps.
+  int64_t _last_frame_us{0};
+  uint8_t _gap_worst_slot{NO_SLOT};  // longest run since the last frame
+  uint32_t _gap_worst_us{0};
+  uint32_t _window_gap_us{0};
+  uint32_t _window_samples{0};
+  uint32_t _window_busy{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_LOOP_TRACE
@@ -0,0 +1,111 @@
+#include "net_worker.h"
+#ifdef USE_RING_CLOCK_NET_WORKER
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <esp_http_client.h>
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+#include <esp_crt_bundle.h>
+#endif
+#include <algorithm>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.net";
+
+  static const int HTTP_TIMEOUT_MS = 10000;
+
+  bool NetWorker::start() {
+    if (_task != nullptr) return true;
+    _jobs = xQueueCreate(QUEUE_LEN, sizeof(NetJob));
+    _results = xQueueCreate(QUEUE_LEN, sizeof(NetResult));
+    if (_jobs == nullptr || _results == nullptr
+        || xTaskCreate(&NetWorker::task_main, "ring_clock_net", _stack_size, this, 1, &_task) != pdPASS) {
+      ESP_LOGE(TAG, "Cannot start the network worker");
+      _task = nullptr;
+      return false;
+    }
+    return true;
+  }
+
+  bool NetWorker::submit(const NetJob &job) {
+    if (!start()) return false;
+    if (xQueueSend(_jobs, &job, 0) != pdTRUE) {
+      ESP_LOGW(TAG, "Worker busy, dropping request for %s", job.url);
+      return false;
+    }
+    return true;
+  }
+
+  bool NetWorker::poll(NetResult *out) {
+    return _results != nullptr && xQueueReceive(_results, out, 0) == pdTRUE;
+  }
+
+  void NetWorker::task_main(void *arg) {
+    auto *self = static_cast<NetWorker *>(arg);
+    NetJob job;
+    NetResult res;
+    for (;;) {
+      if (xQueueReceive(self->_jobs, &job, portMAX_DELAY) != pdTRUE) continue;
+      self->run(job, &res);
+      // loop() drains within a frame or two; waiting keeps results in order.
+      xQueueSend(self->_results, &res, portMAX_DELAY);
+    }
+  }
+
+  void NetWorker::run(const NetJob &job, NetResult *res) {
+    memset(res, 0, sizeof(*res));
+    res->id = job.id;
+    res->status = -1;
+    const uint32_t t0 = millis();
+
+    const char *paths[JsonScanner::MAX_FIELDS];
+    for (uint8_t i = 0; i < job.field_count; i++) paths[i] = job.fields[i];
+    _scanner.begin(paths, job.field_count);
+
+    esp_http_client_config_t cfg{};
+    cfg.url = job.url;
+    cfg.timeout_ms = HTTP_TIMEOUT_MS;
+    cfg.buffer_size = RX_CHUNK;
+    cfg.user_agent = "ESPHome/AL60";
+#if CONFIG_MBEDTLS_CERTIFICATE_BUNDLE
+    cfg.crt_bundle_attach = esp_crt_bundle_attach;
+#endif
+    esp_http_client_handle_t client = esp_http_client_init(&cfg);
+    if (client == nullptr) return;
+
+    if (esp_http_client_open(client, 0) == ESP_OK && esp_http_client_fetch_headers(client) >= 0) {
+      res->status = esp_http_client_get_status_code(client);
+      uint32_t total = 0;
+      while (total < _max_body && !_scanner.all_found()) {
+        const int want = std::min<uint32_t>(RX_CHUNK, _max_body - total);
+        const int n = esp_http_client_read(client, _rx, want);
+        if (n <= 0) break;
+        total += n;
+        if (!_scanner.feed(_rx, n)) {
+          ESP_LOGW(TAG, "Malformed JSON from %s", job.url);
+          break;
+        }
+      }
+      if (total >= _max_body && !_scanner.all_found()) {
+        ESP_LOGW(TAG, "Response from %s exceeds %u bytes, stopped reading", job.url,
+                 (unsigned) _max_body);
+      }
+    }
+    esp_http_client_close(client);
+    esp_http_client_cleanup(client);
+
+    for (uint8_t i = 0; i < job.field_count; i++) {
+      if (!_scanner.is_found(i)) continue;
+      res->found |= 1 << i;
+      strncpy(res->values[i], _scanner.get_value(i), JsonScanner::MAX_VALUE - 1);
+    }
+    res->elapsed_ms = millis() - t0;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_NET_WORKER
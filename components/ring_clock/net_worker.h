@@ -0,0 +1,73 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_NET_WORKER
+
+#include "json_scanner.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// One HTTP GET for the worker: the URL and up to JsonScanner::MAX_FIELDS
+// dotted JSON paths to pick out of the response.
+struct NetJob {
+  static constexpr size_t MAX_URL{160};
+  static constexpr size_t MAX_PATH{48};
+  uint8_t id;
+  uint8_t field_count;
+  char url[MAX_URL];
+  char fields[JsonScanner::MAX_FIELDS][MAX_PATH];
+};
+
+struct NetResult {
+  uint8_t id;
+  uint8_t found;  // bit i: fields[i] was present
+  int16_t status;  // HTTP status, or -1 if the request failed
+  uint32_t elapsed_ms;
+  char values[JsonScanner::MAX_FIELDS][JsonScanner::MAX_VALUE];
+};
+
+// Runs HTTP requests on a FreeRTOS task of its own, so a slow server or TLS
+// handshake never stalls loop().
+//
+// Jobs and results pass through fixed-length queues; the response body is
+// read in RX_CHUNK pieces straight into a JsonScanner and never stored, and
+// reading stops once every field is found or after max_body bytes. The
+// task, its stack and both queues are allocated once, when the first job
+// is submitted, and live for the rest of the run.
+class NetWorker {
+public:
+  static constexpr size_t RX_CHUNK{256};
+  static constexpr uint8_t QUEUE_LEN{2};
+
+  void set_max_body(uint32_t bytes) { _max_body = bytes; }
+  void set_stack_size(uint32_t bytes) { _stack_size = bytes; }
+
+  // From loop(). Returns false if the worker cannot be started or is busy.
+  bool submit(const NetJob &job);
+  // From loop(): next finished job, if any.
+  bool poll(NetResult *out);
+
+protected:
+  bool start();
+  static void task_main(void *arg);
+  void run(const NetJob &job, NetResult *res);
+
+  uint32_t _max_body{16384};
+  uint32_t _stack_size{8192};
+  QueueHandle_t _jobs{nullptr};
+  QueueHandle_t _results{nullptr};
+  TaskHandle_t _task{nullptr};
+  JsonScanner _scanner;  // only touched by the worker task
+  char _rx[RX_CHUNK];
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_NET_WORKER
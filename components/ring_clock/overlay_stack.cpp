@@ -0,0 +1,125 @@
+#include "overlay_stack.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace ring_clock {
+
+  OverlayMask OverlayMask::from_regions(uint8_t regions) {
+    OverlayMask m;
+    if (regions & OVERLAY_REGION_INNER) m.set_range(0, R1_NUM_LEDS);
+    for (int i = 0; i < R2_NUM_LEDS; i++) {
+      const bool marker = i % 4 == 0;
+      if (marker ? (regions & OVERLAY_REGION_MARKERS) : (regions & OVERLAY_REGION_GAPS)) m.set(R1_NUM_LEDS + i);
+    }
+    return m;
+  }
+
+  bool OverlayStack::post(const Overlay &o, uint32_t duration_ms, uint32_t now_ms) {
+    cancel(o.id);
+    if (_count == MAX_OVERLAYS) {
+      // Slot 0 has the lowest priority.
+      if (_items[0].priority >= o.priority) return false;
+      remove_at(0);
+    }
+    // After every overlay of the same or lower priority.
+    uint8_t at = _count;
+    while (at > 0 && _items[at - 1].priority > o.priority) {
+      _items[at] = _items[at - 1];
+      at--;
+    }
+    _items[at] = o;
+    _items[at].timed = duration_ms > 0;
+    _items[at].expires_ms = now_ms + duration_ms;
+    _count++;
+    update_deadline();
+    return true;
+  }
+
+  bool OverlayStack::cancel(uint16_t id) {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_items[i].id == id) {
+        remove_at(i);
+        update_deadline();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const Overlay *OverlayStack::find(uint16_t id) const {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_items[i].id == id) return &_items[i];
+    }
+    return nullptr;
+  }
+
+  void OverlayStack::remove_at(uint8_t index) {
+    for (uint8_t i = index; i + 1 < _count; i++) _items[i] = _items[i + 1];
+    _count--;
+  }
+
+  void OverlayStack::update_deadline() {
+    _has_deadline = false;
+    for (uint8_t i = 0; i < _count; i++) {
+      const Overlay &o = _items[i];
+      if (!o.timed) continue;
+      if (!_has_deadline || (int32_t) (o.expires_ms - _next_deadline_ms) < 0) _next_deadline_ms = o.expires_ms;
+      _has_deadline = true;
+    }
+  }
+
+  bool OverlayStack::expire(uint32_t now_ms) {
+    if (!_has_deadline || (int32_t) (now_ms - _next_deadline_ms) < 0) return false;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      const Overlay &o = _items[i];
+      if (o.timed && (int32_t) (now_ms - o.expires_ms) >= 0) continue;
+      if (kept != i) _items[kept] = o;
+      kept++;
+    }
+    const bool dropped = kept != _count;
+    _count = kept;
+    update_deadline();
+    return dropped;
+  }
+
+  bool OverlayStack::is_animated() const {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_items[i].pattern != OVERLAY_SOLID) return true;
+    }
+    return false;
+  }
+
+  void OverlayStack::composite(light::AddressableLight &it, uint32_t now_ms, const Color *colors) const {
+    const float pulse = 0.3f + 0.7f * ((sinf(now_ms * 0.003f) + 1.0f) / 2.0f);
+    for (uint8_t n = 0; n < _count; n++) {
+      const Overlay &o = _items[n];
+      Color c = o.color_source == FACE_COLOR_RGB ? o.color : colors[o.color_source];
+      if (o.pattern == OVERLAY_PULSE) {
+        c = Color((uint8_t) (c.r * pulse), (uint8_t) (c.g * pulse), (uint8_t) (c.b * pulse));
+      }
+      for (uint8_t w = 0; w < sizeof(o.mask.bits) / sizeof(o.mask.bits[0]); w++) {
+        uint32_t bits = o.mask.bits[w];
+        while (bits != 0) {
+          const int led = w * 32 + __builtin_ctz(bits);
+          bits &= bits - 1;
+          if (led >= TOTAL_LEDS) break;
+          if (o.blend == OVERLAY_REPLACE) {
+            it[led] = c;
+            continue;
+          }
+          const Color b = it[led].get();
+          if (o.blend == OVERLAY_ADD) {
+            it[led] = Color(std::min(255, b.r + c.r), std::min(255, b.g + c.g), std::min(255, b.b + c.b));
+          } else {
+            it[led] = Color(std::max(b.r, c.r), std::max(b.g, c.g), std::max(b.b, c.b));
+          }
+        }
+      }
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/core/color.h"
+#include "face_program.h"
+#include "ring_layout.h"
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Named LED sets for overlays posted by id (YAML / API), combined as bits.
+enum OverlayRegion : uint8_t {
+  OVERLAY_REGION_INNER = 1,    // R1
+  OVERLAY_REGION_MARKERS = 2,  // the 12 hour markers on R2
+  OVERLAY_REGION_GAPS = 4,     // the 36 R2 LEDs between the markers
+  OVERLAY_REGION_OUTER = OVERLAY_REGION_MARKERS | OVERLAY_REGION_GAPS,
+  OVERLAY_REGION_ALL = OVERLAY_REGION_INNER | OVERLAY_REGION_OUTER,
+};
+
+enum OverlayBlend : uint8_t {
+  OVERLAY_REPLACE = 0,
+  OVERLAY_ADD = 1,  // saturating
+  OVERLAY_MAX = 2,  // per channel
+};
+
+enum OverlayPattern : uint8_t {
+  OVERLAY_SOLID = 0,
+  OVERLAY_PULSE = 1,  // 30-100 % brightness, about 2 s period
+};
+
+// One bit per strip LED.
+struct OverlayMask {
+  uint32_t bits[(TOTAL_LEDS + 31) / 32]{};
+
+  void set(int led) { bits[led >> 5] |= 1u << (led & 31); }
+  void set_range(int first, int count) {
+    for (int i = first; i < first + count; i++) set(i);
+  }
+  static OverlayMask from_regions(uint8_t regions);
+};
+
+struct Overlay {
+  uint16_t id{0};       // caller's handle; 0 is never used
+  uint8_t priority{0};  // higher is drawn later, on top
+  OverlayBlend blend{OVERLAY_REPLACE};
+  OverlayPattern pattern{OVERLAY_SOLID};
+  FaceColorSource color_source{FACE_COLOR_RGB};  // or a customisation light
+  Color color{};                                 // for FACE_COLOR_RGB
+  OverlayMask mask;
+  bool timed{false};
+  uint32_t expires_ms{0};
+};
+
+// Fixed set of overlays composited over every face: the alarm and
+// finished-timer pulses, and overlays posted from YAML or the API.
+//
+// Active overlays are kept packed and sorted by priority (equal priorities
+// in posting order), so compositing walks only those, bottom to top, and
+// only the LEDs in each mask. expire() compares the time with the earliest
+// deadline and does nothing else until it has passed.
+class OverlayStack {
+public:
+  static constexpr uint8_t MAX_OVERLAYS{8};
+
+  // Adds overlay o, replacing one with the same id; duration_ms 0 keeps it
+  // until cancelled. When all slots are taken the lowest priority overlay
+  // below o's makes room; returns false if there is none.
+  bool post(const Overlay &o, uint32_t duration_ms, uint32_t now_ms);
+  bool cancel(uint16_t id);
+  const Overlay *find(uint16_t id) const;
+  // Drops overlays whose time is up. True if any was dropped.
+  bool expire(uint32_t now_ms);
+
+  bool empty() const { return _count == 0; }
+  uint8_t size() const { return _count; }
+  // True if an active overlay changes from frame to frame.
+  bool is_animated() const;
+
+  // Draws the active overlays onto a rendered frame. colors resolves
+  // color_source (FaceColorSource index).
+  void composite(light::AddressableLight &it, uint32_t now_ms, const Color *colors) const;
+
+protected:
+  void remove_at(uint8_t index);
+  void update_deadline();
+
+  Overlay _items[MAX_OVERLAYS];
+  uint8_t _count{0};
+  bool _has_deadline{false};
+  uint32_t _next_deadline_ms{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
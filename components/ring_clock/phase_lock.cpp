@@ -0,0 +1,150 @@
+#include "phase_lock.h"
+#ifdef USE_RING_CLOCK_PHASE_LOCK
+
+#include "esphome/components/network/util.h"
+#include "esphome/core/log.h"
+#include <lwip/inet.h>
+#include <lwip/sockets.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.phase";
+
+  // Beacons carry the phase within a second. Errors and the render offset
+  // are both wrapped to half of it, so whole seconds are never chased and
+  // the offset can follow drift indefinitely.
+  static const int32_t PERIOD_MS = 1000;
+  static const int32_t HALF_PERIOD_MS = PERIOD_MS / 2;
+
+  static int32_t wrap_phase(int32_t ms) {
+    if (ms > HALF_PERIOD_MS) return ms - PERIOD_MS;
+    if (ms < -HALF_PERIOD_MS) return ms + PERIOD_MS;
+    return ms;
+  }
+  // Smoothing of the reported error (diagnostics only).
+  static const float ERROR_ALPHA = 0.2f;
+  // Beacons drained per poll(); more than one a second is unusual anyway.
+  static const uint8_t MAX_BEACONS_PER_POLL = 4;
+  // Between attempts to open the socket after one failed.
+  static const uint32_t OPEN_RETRY_MS = 5000;
+
+  void PhaseLock::configure(PhaseRole role, const char *group, uint16_t port) {
+    _role = role;
+    _group = inet_addr(group);
+    _port = port;
+  }
+
+  // Errors are logged for the first failure of a streak only.
+  bool PhaseLock::open_socket() {
+    const bool report = _open_failures == 0;
+    _fd = lwip_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (_fd < 0) {
+      if (report) ESP_LOGE(TAG, "Cannot create socket (errno %d), retrying every %u s", errno,
+                           (unsigned) (OPEN_RETRY_MS / 1000));
+      return false;
+    }
+    int one = 1;
+    lwip_setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    lwip_fcntl(_fd, F_SETFL, lwip_fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    if (_role == PHASE_LEADER) {
+      uint8_t ttl = 1;  // stay on the local segment
+      lwip_setsockopt(_fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    } else {
+      struct sockaddr_in addr {};
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(_port);
+      addr.sin_addr.s_addr = htonl(INADDR_ANY);
+      struct ip_mreq mreq {};
+      mreq.imr_multiaddr.s_addr = _group;
+      mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+      if (lwip_bind(_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+          || lwip_setsockopt(_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+        if (report) ESP_LOGE(TAG, "Cannot join the beacon group (errno %d), retrying every %u s", errno,
+                             (unsigned) (OPEN_RETRY_MS / 1000));
+        lwip_close(_fd);
+        _fd = -1;
+        return false;
+      }
+    }
+    ESP_LOGI(TAG, "%s on port %u", _role == PHASE_LEADER ? "Sending beacons" : "Listening",
+             (unsigned) _port);
+    if (!report) ESP_LOGI(TAG, "Socket open after %u failed attempts", (unsigned) _open_failures);
+    return true;
+  }
+
+  bool PhaseLock::poll(int64_t render_ms, uint32_t now_ms) {
+    if (_fd < 0) {
+      if (!network::is_connected()) return false;
+      if (_open_failures > 0 && now_ms - _open_attempt_ms < OPEN_RETRY_MS) return false;
+      _open_attempt_ms = now_ms;
+      if (!open_socket()) {
+        _open_failures++;
+        return false;
+      }
+      _open_failures = 0;
+    }
+    if (_role != PHASE_FOLLOWER) return false;
+
+    const int32_t before = _offset_ms;
+    PhaseBeacon b;
+    for (uint8_t n = 0; n < MAX_BEACONS_PER_POLL; n++) {
+      const ssize_t len = lwip_recv(_fd, &b, sizeof(b), 0);
+      if (len < 0) break;  // EWOULDBLOCK: drained
+      if (len != sizeof(b) || b.magic != PhaseBeacon::MAGIC || b.version != PhaseBeacon::VERSION
+          || b.ms >= 1000) {
+        continue;
+      }
+      on_beacon(b, render_ms + (_offset_ms - before), now_ms);
+    }
+    return _offset_ms != before;
+  }
+
+  void PhaseLock::on_beacon(const PhaseBeacon &b, int64_t render_ms, uint32_t now_ms) {
+    // Positive error: our seconds tick later than the sender's.
+    const int32_t err = wrap_phase((int32_t) b.ms - (int32_t)(render_ms % PERIOD_MS));
+
+    if (_beacons == 0 || !is_locked(now_ms)) {
+      _error_ms = err;
+      ESP_LOGI(TAG, "Beacon received, phase error %d ms", (int) err);
+    } else {
+      _error_ms += ERROR_ALPHA * (err - _error_ms);
+    }
+    _beacons++;
+    _last_beacon_ms = now_ms;
+
+    // Beacons leave right after the sender's tick, so the target phase is
+    // just past a boundary and a half step never crosses one backwards.
+    const int32_t step = std::max(-PhaseLock::MAX_SLEW_MS, std::min(PhaseLock::MAX_SLEW_MS, err / 2));
+    // Same phase one second over: the shown second steps back or forward
+    // once, onto the one nearest the system clock.
+    _offset_ms = wrap_phase(_offset_ms + step);
+    ESP_LOGV(TAG, "Beacon %u: error %d ms, offset %d ms", (unsigned) b.seq, (int) err,
+             (int) _offset_ms);
+  }
+
+  void PhaseLock::send(int64_t render_ms) {
+    if (_fd < 0 || _role != PHASE_LEADER) return;
+    PhaseBeacon b{};
+    b.magic = PhaseBeacon::MAGIC;
+    b.version = PhaseBeacon::VERSION;
+    b.seq = _seq++;
+    b.unix_s = (uint32_t)(render_ms / 1000);
+    b.ms = (uint16_t)(render_ms % 1000);
+    struct sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(_port);
+    addr.sin_addr.s_addr = _group;
+    if (lwip_sendto(_fd, &b, sizeof(b), 0, (struct sockaddr *) &addr, sizeof(addr)) < 0) {
+      ESP_LOGV(TAG, "Beacon send failed (errno %d)", errno);
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_PHASE_LOCK
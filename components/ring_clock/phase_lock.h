@@ -0,0 +1,81 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_PHASE_LOCK
+
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+enum PhaseRole : uint8_t {
+  PHASE_FOLLOWER = 0,
+  PHASE_LEADER = 1,
+};
+
+// Beacon on the wire, little-endian, 16 bytes. Sent by the leader (or any
+// host, see scripts/phase_beacon.py) right after each of its second ticks.
+struct PhaseBeacon {
+  static constexpr uint32_t MAGIC{0x50364C41UL};  // "AL6P"
+  static constexpr uint8_t VERSION{1};
+
+  uint32_t magic;
+  uint8_t version;
+  uint8_t flags;
+  uint16_t seq;
+  uint32_t unix_s;  // sender's rendered time
+  uint16_t ms;      // 0-999 into unix_s
+  uint16_t reserved;
+} __attribute__((packed));
+
+// LAN phase lock for the rendered seconds.
+//
+// Followers compare each beacon's sub-second phase with their own rendered
+// time on arrival and slew a render offset towards it: half the filtered
+// error per beacon, at most MAX_SLEW_MS. Only the phase is matched; whole
+// seconds stay with each clock's own SNTP/RTC time, and the system clock
+// is never touched. Network latency on a LAN (1-3 ms) is not compensated.
+class PhaseLock {
+public:
+  static constexpr int32_t MAX_SLEW_MS{50};
+  // Beacons stop for this long: hold the offset, report unlocked.
+  static constexpr uint32_t LOCK_TIMEOUT_MS{10000};
+
+  void configure(PhaseRole role, const char *group, uint16_t port);
+  PhaseRole get_role() const { return _role; }
+
+  // Opens the socket once the network is up, then drains received beacons.
+  // render_ms is the current rendered time (system + offset), in epoch ms.
+  // Returns true if the offset changed.
+  bool poll(int64_t render_ms, uint32_t now_ms);
+  // Leader: announce that the rendered time has just ticked.
+  void send(int64_t render_ms);
+
+  int32_t get_offset_ms() const { return _offset_ms; }
+  float get_error_ms() const { return _error_ms; }
+  bool is_locked(uint32_t now_ms) const {
+    return _beacons > 0 && now_ms - _last_beacon_ms < LOCK_TIMEOUT_MS;
+  }
+  uint32_t get_beacon_count() const { return _beacons; }
+
+protected:
+  bool open_socket();
+  void on_beacon(const PhaseBeacon &b, int64_t render_ms, uint32_t now_ms);
+
+  PhaseRole _role{PHASE_FOLLOWER};
+  uint32_t _group{0};  // network byte order
+  uint16_t _port{0};
+  int _fd{-1};
+  uint16_t _seq{0};
+  int32_t _offset_ms{0};
+  float _error_ms{0.0f};
+  uint32_t _beacons{0};
+  uint32_t _last_beacon_ms{0};
+  uint32_t _open_failures{0};  // consecutive, reset once the socket opens
+  uint32_t _open_attempt_ms{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_PHASE_LOCK
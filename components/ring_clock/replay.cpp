@@ -0,0 +1,60 @@
+#include "replay.h"
+#ifdef USE_RING_CLOCK_REPLAY
+
+namespace esphome {
+namespace ring_clock {
+
+  static const uint32_t FNV_OFFSET = 2166136261UL;
+  static const uint32_t FNV_PRIME  = 16777619UL;
+
+  void ReplayRunner::start(time_t start_utc, uint32_t span_s, uint32_t step_ms,
+                           uint32_t duration_ms, uint32_t now_ms) {
+    _stats = ReplayStats();
+    _stats.checksum = FNV_OFFSET;
+    _start_utc = start_utc;
+    _step_ms = step_ms ? step_ms : 1;
+    _duration_ms = duration_ms;
+    _base_ms = now_ms;
+    // Inclusive of the final instant so a 24 h span renders 00:00 twice.
+    _total_frames = (uint32_t)((uint64_t)span_s * 1000 / _step_ms) + 1;
+    _next_frame = 0;
+    _running = true;
+  }
+
+  uint32_t ReplayRunner::frames_due(uint32_t now_ms) const {
+    if (!_running) return 0;
+    uint32_t target = _total_frames;
+    if (_duration_ms != 0) {
+      uint32_t elapsed = now_ms - _base_ms;
+      if (elapsed < _duration_ms)
+        target = (uint32_t)((uint64_t)_total_frames * elapsed / _duration_ms) + 1;
+    }
+    return target > _next_frame ? target - _next_frame : 0;
+  }
+
+  void ReplayRunner::record(uint32_t cost_us, const uint8_t *rgb, size_t len) {
+    uint32_t h = _stats.checksum;
+    for (size_t i = 0; i < len; i++) {
+      h ^= rgb[i];
+      h *= FNV_PRIME;
+    }
+    _stats.checksum = h;
+    _stats.frames++;
+    _stats.total_frame_us += cost_us;
+    if (cost_us < _stats.min_frame_us) _stats.min_frame_us = cost_us;
+    if (cost_us > _stats.max_frame_us) _stats.max_frame_us = cost_us;
+    _next_frame++;
+  }
+
+  void ReplayRunner::end_slice(uint32_t slice_us, uint32_t now_ms) {
+    if (slice_us > _stats.max_slice_us) _stats.max_slice_us = slice_us;
+    if (_next_frame >= _total_frames) {
+      _stats.wall_ms = now_ms - _base_ms;
+      _running = false;
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_REPLAY
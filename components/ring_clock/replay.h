@@ -0,0 +1,108 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_REPLAY
+
+#include "esphome/components/light/addressable_light.h"
+#include "ring_layout.h"
+#include <cstdint>
+#include <ctime>
+
+namespace esphome {
+namespace ring_clock {
+
+// Off-screen AddressableLight backed by a plain RGB array. Replay frames are
+// rendered here so the physical rings keep showing the live clock.
+class FrameCanvas : public light::AddressableLight {
+public:
+  // Fixed linear correction at full brightness, so the checksum depends on
+  // the rendered colours only, not on the light's settings or stale memory.
+  FrameCanvas() {
+    this->correction_.calculate_gamma_table(1.0f);
+    this->correction_.set_max_brightness(Color(255, 255, 255, 255));
+    this->correction_.set_local_brightness(255);
+  }
+
+  int32_t size() const override { return TOTAL_LEDS; }
+  void clear_effect_data() override {}
+  light::LightTraits get_traits() override {
+    light::LightTraits traits;
+    traits.set_supported_color_modes({light::ColorMode::RGB});
+    return traits;
+  }
+  void write_state(light::LightState *state) override {}
+
+  const uint8_t *data() const { return _rgb; }
+
+protected:
+  light::ESPColorView get_view_internal(int32_t index) const override {
+    uint8_t *p = const_cast<uint8_t *>(&_rgb[index * 3]);
+    return light::ESPColorView(p, p + 1, p + 2, nullptr,
+                               const_cast<uint8_t *>(&_effect_data[index]),
+                               &this->correction_);
+  }
+
+  uint8_t _rgb[TOTAL_LEDS * 3]{};
+  uint8_t _effect_data[TOTAL_LEDS]{};
+};
+
+// Statistics for one replay run.
+struct ReplayStats {
+  uint32_t frames{0};
+  uint32_t min_frame_us{UINT32_MAX};
+  uint32_t max_frame_us{0};
+  uint64_t total_frame_us{0};
+  uint32_t max_slice_us{0}; // longest time loop() was held by the replay
+  uint32_t checksum{0};     // FNV-1a over every rendered frame, in order
+  uint32_t wall_ms{0};
+};
+
+// Synthetic clock for time-warp replay.
+//
+// A run covers span_s seconds of simulated time from start_utc, one frame
+// every step_ms of simulated time. Frames are paced so the whole span takes
+// duration_ms of wall time (0 = as fast as the slice budget allows). The
+// owner renders frames from loop(), asking frames_due() how many are owed
+// and reporting each with record(); nothing here touches the real clock.
+class ReplayRunner {
+public:
+  void start(time_t start_utc, uint32_t span_s, uint32_t step_ms,
+             uint32_t duration_ms, uint32_t now_ms);
+  void stop() { _running = false; }
+  bool is_running() const { return _running; }
+
+  // Frames that should have been rendered by now_ms but have not been yet.
+  uint32_t frames_due(uint32_t now_ms) const;
+
+  // Simulated time of the next frame: UTC seconds, and a millis()-style
+  // counter that starts at the real millis() of start() and advances with
+  // simulated time (for animations and timer/stopwatch arithmetic).
+  time_t next_utc() const { return _start_utc + (time_t)(next_offset_ms() / 1000); }
+  uint32_t next_frame_ms() const { return _base_ms + (uint32_t)next_offset_ms(); }
+
+  // Account for one rendered frame and advance to the next one.
+  void record(uint32_t cost_us, const uint8_t *rgb, size_t len);
+  // Account for one loop() slice; finishes the run when the span is covered.
+  void end_slice(uint32_t slice_us, uint32_t now_ms);
+
+  const ReplayStats &get_stats() const { return _stats; }
+  uint32_t get_total_frames() const { return _total_frames; }
+  uint32_t get_step_ms() const { return _step_ms; }
+
+protected:
+  uint64_t next_offset_ms() const { return (uint64_t)_next_frame * _step_ms; }
+
+  ReplayStats _stats;
+  time_t _start_utc{0};
+  uint32_t _step_ms{1000};
+  uint32_t _duration_ms{0};
+  uint32_t _base_ms{0};
+  uint32_t _total_frames{0};
+  uint32_t _next_frame{0};
+  bool _running{false};
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_REPLAY
@@ -1,12 +1,18 @@
 #include "ring_clock.h"
+#include "web_handler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 // lwIP SNTP daemon control — allows truly stopping NTP syncs in manual mode.
 // on_time_sync is notification-only; lwIP has already applied settimeofday()
 // before the callback fires, so the only reliable gate is sntp_stop().
 #ifdef USE_ESP32
 #include "esp_sntp.h"
+#define RING_CLOCK_SNTP_CONTROL
 #elif defined(USE_ESP8266)
 #include "sntp/sntp.h"
+#define RING_CLOCK_SNTP_CONTROL
 #endif
 
 namespace esphome {
@@ -14,8 +20,14 @@ namespace ring_clock {
 
   const char *TAG = "ring_clock.component";
 
+  static const char *const ECO_STATE_NAMES[ECO_STATE_COUNT] = {"Full", "Vacant", "Dark"};
+  static const char *const DETAIL_NAMES[] = {"Near", "Far"};
+
   // --- Helpers ---
 
+  // millis() of an event dated in micros() (e.g. by an interrupt handler).
+  static uint32_t edge_millis(uint32_t at_us) { return millis() - (micros() - at_us) / 1000; }
+
   // IRAM_ATTR: keep in on-chip SRAM so an RMT DMA refill cycle cannot stall this path.
   static IRAM_ATTR Color get_cv_color(const light::LightColorValues& cv) {
       // Use standard as_rgb to capture all compounded brightness factors.
@@ -28,33 +40,179 @@ namespace ring_clock {
   // --- Lifecycle ---
 
   void RingClock::setup() {
+    // RTC and timezone first: the warm-boot restore and the boot frame
+    // below both need the right local time.
+    load_boot_time();
+
     // Sort color gradient points once at boot so per-frame calls to
     // get_temp_color() / get_humid_color() don't need to sort on every call.
     auto cmp = [](const ColorPoint &a, const ColorPoint &b) { return a.value < b.value; };
     std::sort(_temp_color_points.begin(), _temp_color_points.end(), cmp);
     std::sort(_humid_color_points.begin(), _humid_color_points.end(), cmp);
+
+    if (_raw_temp != nullptr) {
+      _raw_temp->add_on_state_callback([this](float t) { this->publish_compensated_temperature(t); });
+    }
+    if (_raw_humid != nullptr) {
+      _raw_humid->add_on_state_callback([this](float rh) { this->publish_compensated_humidity(rh); });
+    }
+
+    // Presence must restore full fidelity before the next frame, not on the
+    // next loop() pass.
+    if (_eco_occupancy != nullptr) {
+      _eco_occupancy->add_on_state_callback([this](bool) { this->update_eco_state(); });
+    }
+    _eco_since_ms = millis();
+    update_eco_state();
+    if (_eco_state_text != nullptr) _eco_state_text->publish_state(ECO_STATE_NAMES[_eco_state]);
+    if (_detail_state_text != nullptr) _detail_state_text->publish_state(DETAIL_NAMES[_detail]);
+
+    if (_imap.load()) {
+      ESP_LOGI(TAG, "Sensor interference map loaded");
+    }
+
+    // Resume timers, stopwatch and alarm from before the reset. The system
+    // clock keeps running through a software reset, so this normally
+    // completes here, before the first frame; after a power cut loop()
+    // finishes it once the RTC or SNTP has set the time.
+    if (_warm.load()) {
+      restore_warm_boot();
+    }
+
+    draw_boot_frame();
+
+    if (_buttons.is_configured()) {
+      _buttons.setup();
+    }
+
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+    _trace.start();
+#endif
+  }
+
+  // Web endpoints share the web_server port; register them only if used.
+  // Called by RingClockWebSetup just after WiFi: RingClock sets up ahead of
+  // it, and init() starts the HTTP server, which needs the network stack.
+  void RingClock::register_web_handler() {
+    bool web_used = _preview != nullptr;
+#ifdef USE_RING_CLOCK_HISTORY
+    web_used |= _history.is_configured();
+#endif
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+    web_used = true;
+#endif
+#ifdef USE_RING_CLOCK_LOCAL_ASSETS
+    web_used |= !_assets.empty();
+#endif
+    if (_web_base == nullptr || !web_used) return;
+    _web_base->init();
+    _web_base->add_handler(new RingClockWebHandler(this));  // NOLINT
   }
 
   void RingClock::loop() {
     // Check if time has become valid (synced via NTP or RTC)
-    if (!_has_time && _time->now().is_valid()) {
+    if (!_has_time && _local_time.now().local.is_valid()) {
       _has_time = true;
+      if (_warm.pending() != nullptr) restore_warm_boot();
       on_ready();
       // Do not return early — fall through so the alarm check runs this tick too
     }
 
-    // Handle Alarm Timeout
-    if (_alarm_active) {
-      if (!_alarm_dispatched) {
-        this->on_alarm_triggered();
-        _alarm_dispatched = true;
+    // Timer expiry: only the earliest deadline (heap root) needs checking.
+    {
+      uint32_t now_ms = millis();
+      // Overlays (alarm, finish pulses, posted ones) time out here; a single
+      // compare until the earliest deadline.
+      if (_overlays.expire(now_ms)) _cache_m = -1;
+      const uint8_t pulses = _timer_pulse_mask;
+      TimerSlot done;
+      while (_timers.pop_expired(now_ms, &done)) {
+        _timer_pulse_mask |= (1 << done.id);
+        this->on_timer_finished(done.id);
+        save_warm_boot();
+      }
+      // Retire finish pulses whose overlay has expired
+      for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+        if ((pulses & (1 << id)) && _overlays.find(OVERLAY_ID_TIMER + id) == nullptr) {
+          _timer_pulse_mask &= ~(1 << id);
+        }
+      }
+      if (_timer_pulse_mask != pulses) {
+        refresh_timer_pulses();
+        // Last timer done and its animation complete — return to clock
+        if (!_timer_pulse_mask && _timers.empty() && _state == state::timer) {
+          _state = state::time;
+        }
       }
-      // Auto-dismiss visual alarm after configured duration
-      if (millis() - _alarm_triggered_ms > ALARM_VISUAL_DURATION_MS) {
-        _alarm_active = false;
+    }
+
+    if (millis() - _warm_refresh_ms >= WARM_BOOT_REFRESH_MS) {
+      save_warm_boot();
+    }
+
+    if (_buttons.is_configured()) {
+      handle_time_buttons();
+    }
+
+    // Effects update every 40-200 ms; draw the crossfade more smoothly.
+    if (_xfade_active && millis() - _frame_ms >= XFADE_FRAME_MS) {
+      draw_now();
+    }
+
+#ifdef USE_RING_CLOCK_HISTORY
+    if (millis() - _history_observe_ms >= 1000) {
+      _history_observe_ms = millis();
+      observe_history();
+    }
+#endif
+
+#ifdef USE_RING_CLOCK_FRAME_OVERLAY
+    // A new overlay frame, or the overlay timing out, needs a fresh base
+    // frame underneath.
+    if (_overlay.poll(millis())) {
+      _cache_m = -1;
+      draw_now();
+    }
+#endif
+
+#ifdef USE_RING_CLOCK_PHASE_LOCK
+    phase_lock_step();
+#endif
+
+#ifdef USE_RING_CLOCK_NET_WORKER
+    net_worker_step();
+#endif
+
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+    if (millis() - _trace_publish_ms >= _trace_publish_interval_ms) {
+      _trace_publish_ms = millis();
+      publish_loop_trace();
+    }
+#endif
+
+    // Eco state follows the light sensor; occupancy changes arrive by callback.
+    update_eco_state();
+    if (millis() - _eco_publish_ms >= ECO_PUBLISH_MS) {
+      publish_eco_times(millis());
+    }
+    update_render_detail();
+
+    // Thermal model: fixed 1 s steps, catching up after long loop stalls.
+    if (_raw_temp != nullptr) {
+      const uint32_t now_ms = millis();
+      const bool lit = _clock_lights != nullptr && _clock_lights->current_values.is_on();
+      while (now_ms - _thermal_step_ms >= ThermalModel::STEP_MS) {
+        _thermal_step_ms += ThermalModel::STEP_MS;
+        _thermal.step(lit ? _led_power_w : 0.0f);
       }
     }
 
+    // Calibration owns the LEDs and the sensor until it finishes.
+    if (_cal_phase != CalPhase::IDLE) {
+      calibration_step(millis());
+      return;
+    }
+
     // --- Smooth brightness stepping ---
     if (_brightness_target >= 0.0f && _brightness_current >= 0.0f
         && _clock_lights != nullptr) {
@@ -78,8 +236,117 @@ namespace ring_clock {
         }
       }
     }
+
+    // --- Synchronised ambient sampling ---
+    if (_ambient_adc != nullptr) {
+      const uint32_t now_ms = millis();
+      switch (_ambient_phase) {
+        case AmbientPhase::IDLE:
+          if (now_ms - _ambient_last_ms >= _ambient_interval_ms) {
+            _ambient_last_ms = now_ms;
+            if (_clock_lights != nullptr && _clock_lights->current_values.is_on()) {
+              // The next rendered frame blanks the window around the sensor.
+              _ambient_phase = AmbientPhase::REQUESTED;
+              _ambient_phase_ms = now_ms;
+            } else {
+              _ambient_adc->update();  // rings are dark: nothing to blank
+            }
+          }
+          break;
+        case AmbientPhase::REQUESTED:
+          if (now_ms - _ambient_phase_ms > AMBIENT_FRAME_TIMEOUT_MS) {
+            // Another effect owns the rings; take an unsynchronised reading.
+            _ambient_phase = AmbientPhase::IDLE;
+            _ambient_adc->update();
+          }
+          break;
+        case AmbientPhase::BLANKED:
+          if (now_ms - _ambient_phase_ms >= AMBIENT_SETTLE_MS) {
+            ambient_sample_and_restore(
+                static_cast<light::AddressableLight *>(_clock_lights->get_output()));
+          }
+          break;
+      }
+    }
+
+#ifdef USE_RING_CLOCK_REPLAY
+    if (_replay.is_running()) {
+      replay_slice();
+    }
+#endif
+  }
+
+#ifdef USE_RING_CLOCK_REPLAY
+  // --- Time-warp Replay ---
+
+  void RingClock::start_replay(state mode, time_t start_utc, uint32_t span_s,
+                               uint32_t step_ms, uint32_t duration_ms) {
+    if (span_s == 0 || step_ms == 0) {
+      ESP_LOGW(TAG, "Replay: span and step must be non-zero");
+      return;
+    }
+    _replay_mode = mode;
+    _replay.start(start_utc, span_s, step_ms, duration_ms, millis());
+    ESP_LOGI(TAG, "Replay: mode %d, %u s from %ld, step %u ms, %u frames over %u ms",
+             (int) mode, (unsigned) span_s, (long) start_utc, (unsigned) step_ms,
+             (unsigned) _replay.get_total_frames(), (unsigned) duration_ms);
+  }
+
+  void RingClock::stop_replay() {
+    if (!_replay.is_running()) return;
+    _replay.stop();
+    ESP_LOGW(TAG, "Replay aborted after %u of %u frames",
+             (unsigned) _replay.get_stats().frames, (unsigned) _replay.get_total_frames());
   }
 
+  // Renders the frames owed since the last slice into the off-screen canvas,
+  // yielding once the slice budget is spent so WiFi and the live display
+  // keep running. A replay that cannot keep up simply takes longer.
+  void RingClock::replay_slice() {
+    const uint32_t slice_start = micros();
+    uint32_t due = _replay.frames_due(millis());
+    if (due == 0) return;
+
+    // Renderer scratch state belongs to the live display; park it so a
+    // replay slice never disturbs the next real frame.
+    const int      saved_last_second    = last_second;
+    const uint32_t saved_last_second_ts = last_second_timestamp;
+    const int      saved_sw_minute      = _stopwatch_last_minute;
+    const uint32_t saved_frame_ms       = _frame_ms;
+    _replaying = true;
+
+    while (due-- > 0) {
+      // Full localtime_r per frame: DST edges in the span are rendered
+      // exactly as the zone rule defines them.
+      const ESPTime now = ESPTime::from_epoch_local(_replay.next_utc());
+      _frame_ms = _replay.next_frame_ms();
+      const uint32_t t0 = micros();
+      render_frame(_replay_canvas, _replay_mode, now);
+      _replay.record(micros() - t0, _replay_canvas.data(), FRAME_BYTES);
+      if (micros() - slice_start >= _replay_slice_budget_us) break;
+    }
+
+    _replaying = false;
+    last_second            = saved_last_second;
+    last_second_timestamp  = saved_last_second_ts;
+    _stopwatch_last_minute = saved_sw_minute;
+    _frame_ms              = saved_frame_ms;
+
+    _replay.end_slice(micros() - slice_start, millis());
+    if (_replay.is_running()) return;
+
+    const ReplayStats &st = _replay.get_stats();
+    const uint32_t avg_us = st.frames ? (uint32_t)(st.total_frame_us / st.frames) : 0;
+    const float speed = st.wall_ms ? (float)st.frames * _replay.get_step_ms() / st.wall_ms : 0.0f;
+    ESP_LOGI(TAG, "Replay done: %u frames in %u ms (%.0fx real time)",
+             (unsigned) st.frames, (unsigned) st.wall_ms, speed);
+    ESP_LOGI(TAG, "  frame cost: min %u us, avg %u us, max %u us; longest loop slice %u us",
+             (unsigned) st.min_frame_us, (unsigned) avg_us, (unsigned) st.max_frame_us,
+             (unsigned) st.max_slice_us);
+    ESP_LOGI(TAG, "  pixel checksum: 0x%08X", (unsigned) st.checksum);
+  }
+#endif
+
   // --- Event & Callback Handlers ---
 
   void RingClock::on_ready() {
@@ -92,22 +359,22 @@ namespace ring_clock {
     this->_on_ready_callback_.add(std::move(callback));
   }
 
-  void RingClock::add_on_timer_finished_callback(std::function<void()> callback) { this->_on_timer_finished_callback_.add(std::move(callback)); }
-  void RingClock::on_timer_finished() {
+  void RingClock::add_on_timer_finished_callback(std::function<void(uint8_t)> callback) { this->_on_timer_finished_callback_.add(std::move(callback)); }
+  void RingClock::on_timer_finished(uint8_t timer_id) {
     if (this->_sound_enabled_switch == nullptr || this->_sound_enabled_switch->state)
-      this->_on_timer_finished_callback_.call();
+      this->_on_timer_finished_callback_.call(timer_id);
   }
 
-  void RingClock::add_on_timer_started_callback(std::function<void()> callback) { this->_on_timer_started_callback_.add(std::move(callback)); }
-  void RingClock::on_timer_started() {
+  void RingClock::add_on_timer_started_callback(std::function<void(uint8_t)> callback) { this->_on_timer_started_callback_.add(std::move(callback)); }
+  void RingClock::on_timer_started(uint8_t timer_id) {
     if (this->_sound_enabled_switch == nullptr || this->_sound_enabled_switch->state)
-      this->_on_timer_started_callback_.call();
+      this->_on_timer_started_callback_.call(timer_id);
   }
 
-  void RingClock::add_on_timer_stopped_callback(std::function<void()> callback) { this->_on_timer_stopped_callback_.add(std::move(callback)); }
-  void RingClock::on_timer_stopped() {
+  void RingClock::add_on_timer_stopped_callback(std::function<void(uint8_t)> callback) { this->_on_timer_stopped_callback_.add(std::move(callback)); }
+  void RingClock::on_timer_stopped(uint8_t timer_id) {
     if (this->_sound_enabled_switch == nullptr || this->_sound_enabled_switch->state)
-      this->_on_timer_stopped_callback_.call();
+      this->_on_timer_stopped_callback_.call(timer_id);
   }
 
   void RingClock::add_on_stopwatch_minute_callback(std::function<void()> callback) { this->_on_stopwatch_minute_callback_.add(std::move(callback)); }
@@ -129,6 +396,9 @@ namespace ring_clock {
   }
 
   void RingClock::add_on_stopwatch_reset_callback(std::function<void()> callback) { this->_on_stopwatch_reset_callback_.add(std::move(callback)); }
+  void RingClock::add_on_stopwatch_lap_callback(std::function<void(uint16_t, uint32_t, uint32_t)> callback) {
+    this->_on_stopwatch_lap_callback_.add(std::move(callback));
+  }
   void RingClock::on_stopwatch_reset() {
     if (this->_sound_enabled_switch == nullptr || this->_sound_enabled_switch->state)
       this->_on_stopwatch_reset_callback_.call();
@@ -139,46 +409,181 @@ namespace ring_clock {
 
   void RingClock::start_alarm() {
     _alarm_triggered_ms = millis();
-    _alarm_dispatched = false;
-    _alarm_active = true;
+    // The sound does not depend on the visual getting a slot.
+    this->on_alarm_triggered();
+    post_alarm_overlay(ALARM_VISUAL_DURATION_MS);
+    save_warm_boot();
+  }
+
+  // Pulses between the markers in the notification colour (white while that
+  // light is off), over whatever face is showing.
+  void RingClock::post_alarm_overlay(uint32_t duration_ms) {
+    Overlay o;
+    o.id = OVERLAY_ID_ALARM;
+    o.priority = OVERLAY_PRIORITY_ALARM;
+    o.pattern = OVERLAY_PULSE;
+    o.color_source = FACE_COLOR_NOTIFICATION;
+    o.mask = OverlayMask::from_regions(OVERLAY_REGION_GAPS);
+    push_overlay(o, duration_ms);
+  }
+
+  // --- Overlays ---
+
+  bool RingClock::post_overlay(uint16_t id, uint8_t priority, uint8_t regions, Color color,
+                               uint32_t duration_ms, OverlayBlend blend, OverlayPattern pattern) {
+    Overlay o;
+    o.id = id;
+    o.priority = priority;
+    o.blend = blend;
+    o.pattern = pattern;
+    o.color = color;
+    o.mask = OverlayMask::from_regions(regions);
+    return post_overlay(o, duration_ms);
+  }
+
+  bool RingClock::post_overlay(const Overlay &overlay, uint32_t duration_ms) {
+    // The ids below are the alarm's and the timers'; posting one would
+    // replace their pulse.
+    if (overlay.id < OVERLAY_ID_USER) {
+      ESP_LOGW(TAG, "Overlay id %u is reserved", overlay.id);
+      return false;
+    }
+    Overlay o = overlay;
+    // Posted overlays never cover the alarm.
+    if (o.priority >= OVERLAY_PRIORITY_ALARM) o.priority = OVERLAY_PRIORITY_ALARM - 1;
+    return push_overlay(o, duration_ms);
+  }
+
+  bool RingClock::push_overlay(const Overlay &overlay, uint32_t duration_ms) {
+    if (!_overlays.post(overlay, duration_ms, millis())) {
+      ESP_LOGW(TAG, "Overlay %u dropped: all %u slots hold higher priorities", overlay.id,
+               OverlayStack::MAX_OVERLAYS);
+      return false;
+    }
+    _cache_m = -1;
+    draw_now();
+    return true;
+  }
+
+  void RingClock::cancel_overlay(uint16_t id) {
+    if (id < OVERLAY_ID_USER || !_overlays.cancel(id)) return;
+    _cache_m = -1;
+    draw_now();
+  }
+
+  // Finish pulses of the timers in _timer_pulse_mask, laid out like
+  // render_timer: alone, a timer pulses between all markers in the
+  // notification colour; with other timers in play, its own quadrant in its
+  // own colour. Pulses keep their remaining time when the layout changes.
+  void RingClock::refresh_timer_pulses() {
+    static const int QUADRANT = R2_NUM_LEDS / MAX_TIMERS;
+    const uint32_t now_ms = millis();
+    int in_play = _timers.size();
+    for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+      if ((_timer_pulse_mask & (1 << id)) && _timers.find(id) == nullptr) in_play++;
+    }
+    for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+      if (!(_timer_pulse_mask & (1 << id))) continue;
+      const Overlay *old = _overlays.find(OVERLAY_ID_TIMER + id);
+      const int32_t left = old != nullptr ? (int32_t) (old->expires_ms - now_ms) : ALARM_VISUAL_DURATION_MS;
+      Overlay o;
+      o.id = OVERLAY_ID_TIMER + id;
+      o.priority = OVERLAY_PRIORITY_TIMER;
+      o.pattern = OVERLAY_PULSE;
+      if (in_play > 1) {
+        o.color = DEFAULT_TIMER_COLORS[id];
+        o.mask.set_range(R1_NUM_LEDS + id * QUADRANT, QUADRANT - 1);
+      } else {
+        o.color_source = FACE_COLOR_NOTIFICATION;
+        o.mask = OverlayMask::from_regions(OVERLAY_REGION_GAPS);
+      }
+      _overlays.post(o, std::max<int32_t>(left, 1), now_ms);
+    }
+    _cache_m = -1;
   }
 
   // --- Logic Control ---
 
-  void RingClock::start_timer(int hours, int minutes, int seconds) {
-    if (hours > 12) hours = 12;
-    if (hours == 12 && minutes > 59) minutes = 59;
-    if (hours == 12 && minutes == 59 && seconds > 59) seconds = 59;
-
-    _timer_duration_ms = (hours * 3600 + minutes * 60 + seconds) * 1000;
-    _timer_target_ms = millis() + _timer_duration_ms;
-    _timer_active = true;
-    _timer_finished_ms = 0;
-    _timer_finishing_dispatched = false;
+  void RingClock::start_timer(uint8_t timer_id, int hours, int minutes, int seconds) {
+    if (timer_id >= MAX_TIMERS) {
+      ESP_LOGW(TAG, "Timer id %u out of range (max %u).", timer_id, MAX_TIMERS - 1);
+      return;
+    }
+    int total = hours * 3600 + minutes * 60 + seconds;
+    if (total < 0) total = 0;
+    if (total > TIMER_MAX_SECONDS) total = TIMER_MAX_SECONDS;
+
+    uint32_t duration_ms = (uint32_t)total * 1000;
+    _timers.push(timer_id, millis() + duration_ms, duration_ms);
+    _timer_pulse_mask &= ~(1 << timer_id);
+    _overlays.cancel(OVERLAY_ID_TIMER + timer_id);
+    refresh_timer_pulses();
     _state = state::timer;
-    this->on_timer_started();
+    ESP_LOGI(TAG, "Timer %u started: %ds (%u running).", timer_id, total, _timers.size());
+    save_warm_boot();
+    this->on_timer_started(timer_id);
+  }
+
+  bool RingClock::remove_timer(uint8_t timer_id) {
+    if (timer_id >= MAX_TIMERS) return false;
+    bool was_running = _timers.remove(timer_id);
+    _timer_pulse_mask &= ~(1 << timer_id);
+    _overlays.cancel(OVERLAY_ID_TIMER + timer_id);
+    refresh_timer_pulses();
+    if (_timers.empty() && !_timer_pulse_mask && _state == state::timer) {
+      _state = state::time;
+    }
+    return was_running;
+  }
+
+  void RingClock::cancel_timer(uint8_t timer_id) {
+    if (!this->remove_timer(timer_id)) return;
+    save_warm_boot();
+    this->on_timer_stopped(timer_id);
+  }
+
+  bool RingClock::is_timer_running(uint8_t timer_id) const {
+    return _timers.find(timer_id) != nullptr;
+  }
+
+  uint32_t RingClock::get_timer_remaining_ms(uint8_t timer_id) const {
+    const TimerSlot *t = _timers.find(timer_id);
+    if (t == nullptr) return 0;
+    int32_t remaining = (int32_t)(t->deadline_ms - millis());
+    return remaining > 0 ? (uint32_t)remaining : 0;
+  }
+
+  void RingClock::start_timer(int hours, int minutes, int seconds) {
+    this->start_timer((uint8_t)0, hours, minutes, seconds);
   }
 
   void RingClock::stop_timer() {
-    _timer_active = false;
+    bool any_running = false;
+    for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+      any_running |= this->remove_timer(id);
+    }
     _state = state::time;
-    this->on_timer_stopped();
+    if (any_running) save_warm_boot();
+    // One stop sound for the Stop Timer button, as before multiple timers.
+    this->on_timer_stopped(0);
   }
 
-  void RingClock::start_stopwatch() {
+  void RingClock::start_stopwatch_at(uint32_t at_ms) {
     if (!_stopwatch_active) {
-      _stopwatch_start_ms = millis() - _stopwatch_paused_ms;
+      _stopwatch_start_ms = at_ms - _stopwatch_paused_ms;
       _stopwatch_active = true;
       _stopwatch_last_minute = -1;
+      save_warm_boot();
       this->on_stopwatch_started();
     }
     _state = state::stopwatch;
   }
 
-  void RingClock::pause_stopwatch() {
+  void RingClock::pause_stopwatch_at(uint32_t at_ms) {
     if (_stopwatch_active) {
-      _stopwatch_paused_ms = millis() - _stopwatch_start_ms;
+      _stopwatch_paused_ms = at_ms - _stopwatch_start_ms;
       _stopwatch_active = false;
+      save_warm_boot();
       this->on_stopwatch_paused();
     }
   }
@@ -187,20 +592,373 @@ namespace ring_clock {
     _stopwatch_active = false;
     _stopwatch_paused_ms = 0;
     _stopwatch_last_minute = -1;
+    _laps.clear();
+    publish_laps();
     _state = state::time;
+    save_warm_boot();
     this->on_stopwatch_reset();
   }
 
-  void RingClock::reset_stopwatch() {
-    _stopwatch_start_ms = millis();
+  void RingClock::reset_stopwatch_at(uint32_t at_ms) {
+    _stopwatch_start_ms = at_ms;
     _stopwatch_paused_ms = 0;
     _stopwatch_last_minute = -1;
+    _laps.clear();
+    publish_laps();
+    save_warm_boot();
     this->on_stopwatch_reset();
   }
 
+  void RingClock::lap_stopwatch_at(uint32_t at_ms) {
+    if (!_stopwatch_active) return;
+    const LapRing::Lap &lap = _laps.add(at_ms - _stopwatch_start_ms);
+    ESP_LOGI(TAG, "Lap %u: %u.%03u s (split %u.%03u s)", lap.number, (unsigned) (lap.lap_ms / 1000),
+             (unsigned) (lap.lap_ms % 1000), (unsigned) (lap.split_ms / 1000), (unsigned) (lap.split_ms % 1000));
+    publish_laps();
+    this->_on_stopwatch_lap_callback_.call(lap.number, lap.lap_ms, lap.split_ms);
+  }
+
+  void RingClock::publish_laps() {
+    const bool any = _laps.total() > 0;
+    if (_last_lap_sensor != nullptr) _last_lap_sensor->publish_state(any ? _laps.get(0).lap_ms / 1000.0f : NAN);
+    if (_best_lap_sensor != nullptr) _best_lap_sensor->publish_state(any ? _laps.best_ms() / 1000.0f : NAN);
+    if (_lap_count_sensor != nullptr) _lap_count_sensor->publish_state(_laps.total());
+  }
+
+  // --- Fast Boot ---
+
+  // Bump the suffix if TimezoneCache changes.
+  static const char *const TZ_PREF_KEY = "ring_clock_tz_v1";
+
+  void RingClock::load_boot_time() {
+    _tz_pref = global_preferences->make_preference<TimezoneCache>(fnv1_hash(TZ_PREF_KEY));
+    _tz_pref_ready = true;
+
+    if (_boot_rtc_read) _boot_rtc_read();
+
+    // The time_zone text entity restores and re-applies this at on_boot
+    // priority 200; until then the YAML default zone would be in force.
+    if (_tz_pref.load(&_tz_cache) && _tz_cache.posix[0] != '\0') {
+      _tz_cache.posix[TZ_CACHE_LEN - 1] = '\0';
+      setenv("TZ", _tz_cache.posix, 1);
+      tzset();
+    } else {
+      memset(&_tz_cache, 0, sizeof(_tz_cache));
+    }
+    _local_time.invalidate();
+  }
+
+  void RingClock::draw_boot_frame() {
+    if (_boot_rtc_read == nullptr || _clock_lights == nullptr) return;
+    const esphome::ESPTime &now = _local_time.now().local;
+    if (!now.is_valid()) {
+      ESP_LOGW(TAG, "Fast boot: RTC time not valid, waiting for the effect");
+      return;
+    }
+    // The restored light state may still be fading in. Finish that fade
+    // through a regular call, so LightState publishes the values we draw at.
+    if (!_clock_lights->remote_values.is_on()) return;
+    auto call = _clock_lights->make_call();
+    call.set_state(true);
+    call.set_transition_length(0);
+    call.perform();
+
+    auto *out = static_cast<light::AddressableLight *>(_clock_lights->get_output());
+    out->update_state(_clock_lights);  // brightness into the colour correction
+    _frame_ms = millis();
+    render_frame(*out, _state, now, true);
+    // loop() has not started, so nothing else would send it yet.
+    out->write_state(_clock_lights);
+    note_first_frame();
+  }
+
+  void RingClock::note_first_frame() {
+    _first_frame_done = true;
+    const uint32_t ms = millis();
+    ESP_LOGI(TAG, "First frame %u ms after boot", (unsigned) ms);
+    if (_first_frame_sensor != nullptr) _first_frame_sensor->publish_state(ms);
+  }
+
+  void RingClock::remember_timezone() {
+    if (!_tz_pref_ready) return;
+    const char *tz = getenv("TZ");
+    if (tz == nullptr || strncmp(tz, _tz_cache.posix, TZ_CACHE_LEN) == 0) return;
+    if (strlen(tz) >= TZ_CACHE_LEN) {
+      ESP_LOGW(TAG, "Timezone rule too long to cache for fast boot: %s", tz);
+      return;
+    }
+    memset(&_tz_cache, 0, sizeof(_tz_cache));
+    strncpy(_tz_cache.posix, tz, TZ_CACHE_LEN - 1);
+    _tz_pref.save(&_tz_cache);
+  }
+
+#ifdef USE_RING_CLOCK_HISTORY
+  // --- Sensor History ---
+
+  void RingClock::observe_history() {
+    if (!_has_time) return;  // samples are filed by UTC
+    float v[HISTORY_CHANNELS];
+    v[HISTORY_TEMPERATURE] = _temp_sensor != nullptr ? _temp_sensor->state : NAN;
+    v[HISTORY_HUMIDITY] = _humidity_sensor != nullptr ? _humidity_sensor->state : NAN;
+    sensor::Sensor *light = _eco_light != nullptr ? _eco_light : _ambient_sensor;
+    v[HISTORY_LIGHT] = light != nullptr && light->has_state() ? light->state : NAN;
+    v[HISTORY_OCCUPANCY] = _eco_occupancy != nullptr && _eco_occupancy->has_state()
+                               ? (_eco_occupancy->state ? 1.0f : 0.0f)
+                               : NAN;
+    _history.observe(_local_time.now().utc, v);
+  }
+#endif
+
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+  // --- Main Loop Tracer ---
+
+  void RingClock::publish_loop_trace() {
+    TraceWindow w;
+    _trace.take_window(&w);
+    if (w.frame_gap_ms >= _trace.get_gap_threshold_ms() || w.worst_ms >= _trace.get_stall_threshold_ms()) {
+      ESP_LOGW(TAG, "Loop trace: worst frame gap %.0f ms, longest run %.0f ms in %s",
+               w.frame_gap_ms, w.worst_ms, w.worst_name != nullptr ? w.worst_name : "-");
+    }
+    if (_trace_worst_text != nullptr) {
+      char buf[48];
+      if (w.worst_name != nullptr) {
+        snprintf(buf, sizeof(buf), "%s (%.0f ms)", w.worst_name, w.worst_ms);
+      } else {
+        snprintf(buf, sizeof(buf), "none");
+      }
+      _trace_worst_text->publish_state(buf);
+    }
+    if (_trace_worst_stall_sensor != nullptr) _trace_worst_stall_sensor->publish_state(w.worst_ms);
+    if (_trace_frame_gap_sensor != nullptr) _trace_frame_gap_sensor->publish_state(w.frame_gap_ms);
+    if (_trace_loop_load_sensor != nullptr) _trace_loop_load_sensor->publish_state(w.load_pct);
+  }
+#endif
+
+#ifdef USE_RING_CLOCK_NET_WORKER
+  // --- Background Network Fetches ---
+
+  bool RingClock::fetch_json(const std::string &url, std::initializer_list<const char *> fields,
+                             FetchCallback callback) {
+    if (url.size() >= NetJob::MAX_URL || fields.size() > JsonScanner::MAX_FIELDS) {
+      ESP_LOGE(TAG, "fetch_json: URL or field list too long");
+      return false;
+    }
+    PendingFetch *slot = nullptr;
+    for (auto &f : _fetches) {
+      if (f.id == 0) {
+        slot = &f;
+        break;
+      }
+    }
+    if (slot == nullptr) {
+      ESP_LOGW(TAG, "fetch_json: too many requests in flight, dropping %s", url.c_str());
+      return false;
+    }
+
+    static NetJob job;  // large; built and copied into the queue from loop() only
+    memset(&job, 0, sizeof(job));
+    job.id = _fetch_next_id;
+    strncpy(job.url, url.c_str(), NetJob::MAX_URL - 1);
+    for (const char *field : fields) {
+      strncpy(job.fields[job.field_count++], field, NetJob::MAX_PATH - 1);
+    }
+    if (!_net.submit(job)) return false;
+
+    slot->id = job.id;
+    slot->field_count = job.field_count;
+    slot->callback = std::move(callback);
+    _fetch_next_id = _fetch_next_id == UINT8_MAX ? 1 : _fetch_next_id + 1;
+    return true;
+  }
+
+  void RingClock::net_worker_step() {
+    static NetResult res;
+    while (_net.poll(&res)) {
+      ESP_LOGD(TAG, "Fetch %u finished: status %d in %u ms", res.id, res.status,
+               (unsigned) res.elapsed_ms);
+      for (auto &f : _fetches) {
+        if (f.id != res.id) continue;
+        std::vector<std::string> values(f.field_count);
+        for (uint8_t i = 0; i < f.field_count; i++) {
+          if ((res.found >> i) & 1) values[i] = res.values[i];
+        }
+        FetchCallback cb = std::move(f.callback);
+        f.id = 0;
+        f.callback = nullptr;
+        if (cb) cb(res.status, values);
+        break;
+      }
+    }
+  }
+#endif
+
+#ifdef USE_RING_CLOCK_PHASE_LOCK
+  // --- LAN Phase Lock ---
+
+  void RingClock::phase_lock_step() {
+    const uint32_t now_ms = millis();
+    const LocalTime *t = &_local_time.now();
+    if (!t->local.is_valid()) return;
+
+    if (_phase.poll((int64_t) t->utc * 1000 + t->ms, now_ms)) {
+      _local_time.set_phase_offset_ms(_phase.get_offset_ms());
+      t = &_local_time.now();
+    }
+
+    if (t->utc != _phase_tick_s) {
+      const bool first = _phase_tick_s == 0;
+      _phase_tick_s = t->utc;
+      if (!first) {
+        _phase.send((int64_t) t->utc * 1000 + t->ms);
+        // The next effect update may be up to an update_interval away.
+        draw_now();
+      }
+    }
+
+    if (t->ms >= 1000 - PHASE_WINDOW_MS || t->ms < PHASE_WINDOW_MS) {
+      _phase_hf.start();
+    } else {
+      _phase_hf.stop();
+    }
+
+    if (_phase.get_role() != PHASE_FOLLOWER) return;
+    const bool locked = _phase.is_locked(now_ms);
+    if (locked != _phase_locked) {
+      _phase_locked = locked;
+      if (locked) {
+        ESP_LOGI(TAG, "Phase lock acquired");
+      } else {
+        ESP_LOGW(TAG, "Phase beacons lost, holding offset %d ms", (int) _phase.get_offset_ms());
+      }
+    }
+    if (_phase_error_sensor != nullptr && now_ms - _phase_publish_ms >= PHASE_PUBLISH_MS) {
+      _phase_publish_ms = now_ms;
+      _phase_error_sensor->publish_state(locked ? _phase.get_error_ms() : NAN);
+    }
+  }
+#endif
+
+  // --- Warm Boot ---
+
+  void RingClock::on_shutdown() {
+    save_warm_boot();
+    _warm.commit();
+  }
+
+  void RingClock::save_warm_boot() {
+    _warm_refresh_ms = millis();
+    // An unapplied snapshot is the only record of what was running, and
+    // without a valid clock nothing can be expressed in UTC.
+    if (_warm.pending() != nullptr) return;
+    const LocalTime &lt = _local_time.now();
+    if (!lt.local.is_valid()) return;
+    const int64_t utc_ms = (int64_t) lt.utc * 1000 + lt.ms;
+    const uint32_t now_ms = millis();
+
+    WarmBootSnapshot snap;
+    memset(&snap, 0, sizeof(snap));  // padding is covered by the checksum
+    for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+      const TimerSlot *t = _timers.find(id);
+      if (t == nullptr) continue;
+      auto &out = snap.timers[snap.timer_count++];
+      out.id = id;
+      out.duration_ms = t->duration_ms;
+      out.deadline_utc_ms = utc_ms + (int32_t)(t->deadline_ms - now_ms);
+    }
+    if (_stopwatch_active) {
+      snap.flags |= WarmBootSnapshot::STOPWATCH_RUNNING;
+      snap.stopwatch_start_utc_ms = utc_ms - (int64_t)(now_ms - _stopwatch_start_ms);
+    } else if (_stopwatch_paused_ms != 0) {
+      snap.flags |= WarmBootSnapshot::STOPWATCH_PAUSED;
+      snap.stopwatch_paused_ms = _stopwatch_paused_ms;
+    }
+    if (is_alarm_active()) {
+      snap.flags |= WarmBootSnapshot::ALARM_ACTIVE;
+      snap.alarm_utc_ms = utc_ms - (int64_t)(now_ms - _alarm_triggered_ms);
+    }
+    _warm.update(snap);
+  }
+
+  bool RingClock::restore_warm_boot() {
+    const WarmBootSnapshot *snap = _warm.pending();
+    if (snap == nullptr) return false;
+    const LocalTime &lt = _local_time.now();
+    if (!lt.local.is_valid()) {
+      ESP_LOGI(TAG, "Warm boot: state found, waiting for valid time");
+      return false;
+    }
+    const int64_t utc_ms = (int64_t) lt.utc * 1000 + lt.ms;
+    const uint32_t now_ms = millis();
+
+    // Anything started since boot takes precedence over the snapshot.
+    for (uint8_t i = 0; i < snap->timer_count; i++) {
+      const WarmBootSnapshot::Timer &t = snap->timers[i];
+      if (t.id >= MAX_TIMERS || _timers.find(t.id) != nullptr) continue;
+      int64_t remaining = t.deadline_utc_ms - utc_ms;
+      if (remaining < -(int64_t) WARM_BOOT_GRACE_MS) {
+        ESP_LOGW(TAG, "Warm boot: timer %u expired %lld s ago, dropped",
+                 t.id, (long long)(-remaining / 1000));
+        continue;
+      }
+      // Overdue timers are armed at now and ring on the next loop() pass.
+      remaining = std::max<int64_t>(0, std::min<int64_t>(remaining, t.duration_ms));
+      _timers.push(t.id, now_ms + (uint32_t) remaining, t.duration_ms);
+      ESP_LOGI(TAG, "Warm boot: timer %u resumed, %lld ms left", t.id, (long long) remaining);
+    }
+
+    if (!_stopwatch_active && _stopwatch_paused_ms == 0) {
+      if (snap->flags & WarmBootSnapshot::STOPWATCH_RUNNING) {
+        int64_t elapsed = utc_ms - snap->stopwatch_start_utc_ms;
+        elapsed = std::max<int64_t>(0, std::min<int64_t>(elapsed, INT32_MAX));
+        _stopwatch_start_ms = now_ms - (uint32_t) elapsed;
+        _stopwatch_active = true;
+        _stopwatch_last_minute = -1;
+        ESP_LOGI(TAG, "Warm boot: stopwatch resumed at %lld ms", (long long) elapsed);
+      } else if (snap->flags & WarmBootSnapshot::STOPWATCH_PAUSED) {
+        _stopwatch_paused_ms = snap->stopwatch_paused_ms;
+        ESP_LOGI(TAG, "Warm boot: stopwatch paused at %u ms", (unsigned) _stopwatch_paused_ms);
+      }
+    }
+
+    if (!is_alarm_active() && (snap->flags & WarmBootSnapshot::ALARM_ACTIVE)) {
+      const int64_t elapsed = utc_ms - snap->alarm_utc_ms;
+      if (elapsed >= 0 && elapsed < ALARM_VISUAL_DURATION_MS) {
+        // The sound was cut by the reset; only the visual resumes.
+        _alarm_triggered_ms = now_ms - (uint32_t) elapsed;
+        post_alarm_overlay(ALARM_VISUAL_DURATION_MS - (uint32_t) elapsed);
+      }
+    }
+
+    if (!_timers.empty()) {
+      _state = state::timer;
+    } else if (_stopwatch_active) {
+      _state = state::stopwatch;
+    }
+    _warm.consume();
+    save_warm_boot();
+    return true;
+  }
+
   state RingClock::get_state() { return _state; }
   void RingClock::set_state(state s) { _state = s; }
 
+  // --- Custom Faces ---
+
+  void RingClock::add_face(const char *name, const uint8_t *code, size_t len) {
+    if (!FaceProgram::validate(code, len)) {
+      ESP_LOGE(TAG, "Face '%s' is not a valid program, ignoring it", name);
+      return;
+    }
+    _faces.push_back({name, code});
+  }
+
+  int RingClock::find_face(const std::string &name) const {
+    for (size_t i = 0; i < _faces.size(); i++) {
+      if (name == _faces[i].name) return (int) i;
+    }
+    return -1;
+  }
+
   // --- Configuration Setters ---
 
   void RingClock::set_time(time::RealTimeClock *time) { _time = time; }
@@ -213,19 +971,236 @@ namespace ring_clock {
   void RingClock::set_blank_leds(std::vector<int> leds) { this->_blanked_leds = leds; }
   float RingClock::get_interference_factor() { return this->_interference_factor; }
 
-  // --- Time Management ---
+  // --- Eco Rendering ---
 
-  // Proleptic Gregorian calendar fields -> Unix UTC epoch.
-  // Pure arithmetic, no mktime(), no TZ environment side-effects.
-  time_t RingClock::fields_to_epoch(int year, int month, int day,
-                                    int hour, int minute, int second) {
-    int y = year, m = month;
-    if (m <= 2) { y--; m += 12; }
-    long days = 365L * y + y / 4 - y / 100 + y / 400
-              + (153 * (m - 3) + 2) / 5 + day - 719469;
-    return (time_t)(days * 86400L + (long)hour * 3600L + (long)minute * 60L + second);
+  void RingClock::set_eco_enabled(bool enabled) {
+    _eco_enabled = enabled;
+    update_eco_state();
   }
 
+  void RingClock::update_eco_state() {
+    if (_eco_light != nullptr && !std::isnan(_eco_light->state)) {
+      const float lux = _eco_light->state;
+      if (_eco_is_dark) {
+        if (lux > _eco_dark_below + _eco_hysteresis) _eco_is_dark = false;
+      } else if (lux < _eco_dark_below) {
+        _eco_is_dark = true;
+      }
+    }
+
+    EcoState next = ECO_FULL;
+    if (_eco_enabled) {
+      if (_eco_is_dark)
+        next = ECO_DARK;
+      else if (_eco_occupancy != nullptr && !_eco_occupancy->state)
+        next = ECO_VACANT;
+    }
+    if (next == _eco_state) return;
+
+    const uint32_t now_ms = millis();
+    _eco_time_ms[_eco_state] += now_ms - _eco_since_ms;
+    _eco_since_ms = now_ms;
+    ESP_LOGD(TAG, "Eco state: %s -> %s", ECO_STATE_NAMES[_eco_state], ECO_STATE_NAMES[next]);
+    _eco_state = next;
+    _cache_m = -1;  // the next frame switches face
+    if (_eco_state_text != nullptr) _eco_state_text->publish_state(ECO_STATE_NAMES[next]);
+    publish_eco_times(now_ms);
+  }
+
+  // Cumulative seconds spent in each state since boot.
+  void RingClock::publish_eco_times(uint32_t now_ms) {
+    _eco_publish_ms = now_ms;
+    for (int i = 0; i < ECO_STATE_COUNT; i++) {
+      if (_eco_time_sensors[i] == nullptr) continue;
+      uint64_t ms = _eco_time_ms[i];
+      if (i == _eco_state) ms += now_ms - _eco_since_ms;
+      _eco_time_sensors[i]->publish_state(ms / 1000);
+    }
+  }
+
+  // --- Render Detail ---
+
+  void RingClock::update_render_detail() {
+    if (_detail_moving == nullptr && _detail_still == nullptr) return;
+    // The LD2410 reports 0 for a target kind it does not see.
+    float distance = NAN;
+    for (sensor::Sensor *s : {_detail_moving, _detail_still}) {
+      if (s == nullptr || !(s->state > 0.0f)) continue;
+      if (std::isnan(distance) || s->state < distance) distance = s->state;
+    }
+    // Nobody in range: keep the level, eco covers an empty room.
+    if (std::isnan(distance)) {
+      _detail_pending = false;
+      return;
+    }
+
+    const bool want_far = _detail == DETAIL_FAR
+        ? distance >= _detail_far_above - _detail_hysteresis
+        : distance > _detail_far_above;
+    const RenderDetail next = want_far ? DETAIL_FAR : DETAIL_NEAR;
+    const uint32_t now_ms = millis();
+    if (next == _detail) {
+      _detail_pending = false;
+      return;
+    }
+    if (!_detail_pending) {
+      _detail_pending = true;
+      _detail_pending_ms = now_ms;
+    }
+    if (now_ms - _detail_pending_ms < _detail_switch_delay_ms) return;
+
+    ESP_LOGD(TAG, "Render detail: %s -> %s (%.0f)", DETAIL_NAMES[_detail], DETAIL_NAMES[next], distance);
+    _detail = next;
+    _detail_pending = false;
+    _cache_m = -1;  // the next frame switches face
+    if (_detail_state_text != nullptr) _detail_state_text->publish_state(DETAIL_NAMES[next]);
+  }
+
+  // --- Thermal Self-heating Compensation ---
+
+  void RingClock::publish_compensated_temperature(float raw) {
+    if (_comp_temp == nullptr || std::isnan(raw)) return;
+    _comp_temp->publish_state(raw - _thermal.get_rise() + _temp_trim);
+  }
+
+  void RingClock::publish_compensated_humidity(float raw_rh) {
+    if (_comp_humid == nullptr || std::isnan(raw_rh)) return;
+    float rh = raw_rh;
+    const float t_raw = _raw_temp != nullptr ? _raw_temp->state : NAN;
+    if (!std::isnan(t_raw)) {
+      const float t_amb = t_raw - _thermal.get_rise() + _temp_trim;
+      rh = ThermalModel::correct_rh(raw_rh, t_raw, t_amb);
+    }
+    _comp_humid->publish_state(std::max(0.0f, std::min(100.0f, rh + _humid_trim)));
+  }
+
+  // --- Sensor Interference Calibration ---
+
+  void RingClock::start_interference_calibration() {
+    if (_ambient_adc == nullptr || _ambient_sensor == nullptr || _clock_lights == nullptr) {
+      ESP_LOGE(TAG, "Interference calibration needs ambient_sampling configured");
+      return;
+    }
+    if (_cal_phase != CalPhase::IDLE) return;
+    if (!_clock_lights->current_values.is_on()) {
+      auto call = _clock_lights->turn_on();
+      call.set_transition_length(0);
+      call.perform();
+    }
+    auto *out = static_cast<light::AddressableLight *>(_clock_lights->get_output());
+    out->all() = Color(0, 0, 0);
+    out->schedule_show();
+    _ambient_phase = AmbientPhase::IDLE;
+    _cal_step = 0;
+    _cal_phase = CalPhase::DARK;
+    _cal_phase_ms = millis();
+    ESP_LOGI(TAG, "Interference calibration started (%d steps)", TOTAL_LEDS * 3);
+  }
+
+  void RingClock::cancel_interference_calibration() {
+    if (_cal_phase == CalPhase::IDLE) return;
+    ESP_LOGW(TAG, "Interference calibration cancelled at step %u", (unsigned) _cal_step);
+    _imap.load();  // drop the partial table
+    end_calibration();
+  }
+
+  void RingClock::clear_interference_map() {
+    _imap.clear();
+    _interference_mv = 0.0f;
+    ESP_LOGI(TAG, "Sensor interference map cleared");
+  }
+
+  // One measurement per settle period: a dark reading, then the same LED
+  // channel lit. Measuring dark before every channel cancels slow drift in
+  // the room light.
+  void RingClock::calibration_step(uint32_t now_ms) {
+    if (now_ms - _cal_phase_ms < CAL_SETTLE_MS) return;
+    auto *out = static_cast<light::AddressableLight *>(_clock_lights->get_output());
+    const int led = _cal_step / 3;
+    const int ch  = _cal_step % 3;
+
+    _ambient_adc->update();
+    const float v = _ambient_sensor->get_raw_state();
+
+    if (_cal_phase == CalPhase::DARK) {
+      _cal_dark_v = v;
+      (*out)[led] = Color(ch == 0 ? 255 : 0, ch == 1 ? 255 : 0, ch == 2 ? 255 : 0);
+      auto px = (*out)[led];
+      _cal_level = ch == 0 ? px.get_red_raw() : ch == 1 ? px.get_green_raw() : px.get_blue_raw();
+      _cal_phase = CalPhase::LIT;
+    } else {
+      _imap.set_weight(led, ch, (v - _cal_dark_v) * 1000.0f, _cal_level);
+      (*out)[led] = Color(0, 0, 0);
+      if (++_cal_step >= TOTAL_LEDS * 3) {
+        end_calibration();
+        return;
+      }
+      _cal_phase = CalPhase::DARK;
+    }
+    out->schedule_show();
+    _cal_phase_ms = now_ms;
+  }
+
+  void RingClock::end_calibration() {
+    if (_cal_step >= TOTAL_LEDS * 3) {
+      int max_k = 0;
+      uint32_t total = 0;
+      for (int k = 0; k < TOTAL_LEDS * 3; k++) {
+        uint16_t w = _imap.get_weight(k / 3, k % 3);
+        total += w;
+        if (w > _imap.get_weight(max_k / 3, max_k % 3)) max_k = k;
+      }
+      bool saved = _imap.save();
+      const float unit = 1 << InterferenceMap::WEIGHT_FRAC_BITS;
+      ESP_LOGI(TAG, "Interference calibration done%s: full white %.1f mV, strongest LED %d ch %d (%.1f mV)",
+               saved ? "" : " (NVS save failed)", total / unit, max_k / 3, max_k % 3,
+               _imap.get_weight(max_k / 3, max_k % 3) / unit);
+    }
+    _cal_phase = CalPhase::IDLE;
+    _cache_m = -1;  // next effect frame re-renders the clock face
+  }
+
+  // --- Synchronised Ambient Sampling ---
+
+  int RingClock::ambient_led(int k) const {
+    const int width = 2 * _ambient_radius + 1;
+    const int d = (k % width) - _ambient_radius;
+    if (k < width) return (SENSOR_ADJACENT_LED_R1 + d + R1_NUM_LEDS) % R1_NUM_LEDS;
+    return R1_NUM_LEDS + (SENSOR_ADJACENT_LED_R2 + d + R2_NUM_LEDS) % R2_NUM_LEDS;
+  }
+
+  void RingClock::ambient_blank(light::AddressableLight &it) {
+    const int count = 2 * (2 * _ambient_radius + 1);
+    for (int k = 0; k < count; k++) {
+      const int led = ambient_led(k);
+      _ambient_saved[k] = it[led].get();
+      it[led] = Color(0, 0, 0);
+    }
+    _ambient_phase = AmbientPhase::BLANKED;
+    _ambient_phase_ms = millis();
+  }
+
+  // Reads the ADC while the blanked frame is showing. With `it` the hidden
+  // pixels are written back straight away; without it the caller is about
+  // to render a full frame anyway.
+  void RingClock::ambient_sample_and_restore(light::AddressableLight *it) {
+    _ambient_adc->update();
+    _ambient_phase = AmbientPhase::IDLE;
+    if (it == nullptr) return;
+    const int count = 2 * (2 * _ambient_radius + 1);
+    for (int k = 0; k < count; k++) {
+      (*it)[ambient_led(k)] = _ambient_saved[k];
+    }
+    it->schedule_show();
+  }
+
+  void RingClock::enable_frame_preview(uint32_t min_interval_ms) {
+    if (_preview == nullptr) _preview = new FramePreview();  // NOLINT
+    _preview->set_min_interval(min_interval_ms);
+  }
+
+  // --- Time Management ---
+
   void RingClock::set_sntp_enabled(bool enabled) {
     _sntp_enabled = enabled;
     if (!_network_ready) {
@@ -235,6 +1210,7 @@ namespace ring_clock {
                enabled ? "enabled" : "disabled (manual mode)");
       return;
     }
+#ifdef RING_CLOCK_SNTP_CONTROL
     if (enabled) {
       if (!esp_sntp_enabled()) {
         esp_sntp_init();
@@ -246,10 +1222,12 @@ namespace ring_clock {
       }
       ESP_LOGI(TAG, "SNTP daemon stopped (manual mode).");
     }
+#endif
   }
 
   void RingClock::set_network_ready() {
     _network_ready = true;
+#ifdef RING_CLOCK_SNTP_CONTROL
     if (!_sntp_enabled) {
       // Apply pending manual-mode stop
       if (esp_sntp_enabled()) {
@@ -268,6 +1246,7 @@ namespace ring_clock {
       esp_sntp_init();
       ESP_LOGI(TAG, "Network ready: SNTP daemon restarted — syncing now.");
     }
+#endif
   }
 
   void RingClock::set_target_brightness(float target) {
@@ -301,25 +1280,23 @@ namespace ring_clock {
     }
     struct timeval tv = { .tv_sec = utc_epoch, .tv_usec = 0 };
     settimeofday(&tv, NULL);
+    _local_time.invalidate();
     ESP_LOGW(TAG, "SNTP sync applied — UTC epoch: %ld", (long)utc_epoch);
   }
 
   void RingClock::set_manual_time(int year, int month, int day,
                                    int hour, int minute, int second) {
-    // Derive the active timezone offset.
-    time_t utc_now = _time->timestamp_now();
-    auto now = _time->now();
-    time_t local_as_utc = fields_to_epoch(
-        now.year, now.month, now.day_of_month,
-        now.hour, now.minute, now.second);
-    int32_t tz_offset = (int32_t)(local_as_utc - utc_now);
+    // The active timezone offset comes from the cached snapshot, so it is
+    // consistent with the fields the clock face is currently showing.
+    int32_t tz_offset = _local_time.now().offset;
 
     // Convert the user-entered local datetime to UTC and apply
-    time_t entered_utc = fields_to_epoch(year, month, day, hour, minute, second);
+    time_t entered_utc = LocalTimeCache::fields_to_epoch(year, month, day, hour, minute, second);
     time_t utc_epoch   = entered_utc - tz_offset;
 
     struct timeval tv = { .tv_sec = utc_epoch, .tv_usec = 0 };
     settimeofday(&tv, NULL);
+    _local_time.invalidate();
 
     // Switch to manual mode — block future automatic SNTP overwrites
     set_sntp_enabled(false);
@@ -327,46 +1304,106 @@ namespace ring_clock {
              (long)utc_epoch, tz_offset);
   }
 
-  void RingClock::increment_hour() {
-    time_t utc_now = _time->timestamp_now();
-    auto now = _time->now();
-    time_t local_as_utc = fields_to_epoch(
-        now.year, now.month, now.day_of_month,
-        now.hour, now.minute, now.second);
-    int32_t tz_offset = (int32_t)(local_as_utc - utc_now);
+  time_t RingClock::stepped_utc(int32_t hours, int32_t minutes) {
+    // One snapshot: fields and offset derive from the same UTC second, so a
+    // press landing on a second boundary cannot mix two different instants.
+    const LocalTime &lt = _local_time.now();
+    const ESPTime &now = lt.local;
 
-    // Increment hour with wrapping (0-23)
-    now.hour = (now.hour + 1) % 24;
-    now.second = 0;
+    // Wrap each field in isolation (23 -> 0 keeps the date, 59 -> 0 keeps
+    // the hour).
+    const int hour   = ((now.hour + hours) % 24 + 24) % 24;
+    const int minute = ((now.minute + minutes) % 60 + 60) % 60;
 
-    time_t entered_utc = fields_to_epoch(now.year, now.month, now.day_of_month, now.hour, now.minute, now.second);
-    time_t utc_epoch   = entered_utc - tz_offset;
+    time_t entered_utc = LocalTimeCache::fields_to_epoch(
+        now.year, now.month, now.day_of_month, hour, minute, 0);
+    return entered_utc - lt.offset;
+  }
 
-    struct timeval tv = { .tv_sec = utc_epoch, .tv_usec = 0 };
+  void RingClock::step_local_time(int32_t hours, int32_t minutes, const char *what) {
+    struct timeval tv = { .tv_sec = stepped_utc(hours, minutes), .tv_usec = 0 };
     settimeofday(&tv, NULL);
+    _local_time.invalidate();
     set_sntp_enabled(false);
-    ESP_LOGI(TAG, "Hour incremented (isolated, wrapped).");
+    ESP_LOGI(TAG, "%s incremented (isolated, wrapped).", what);
   }
 
-  void RingClock::increment_minute() {
-    time_t utc_now = _time->timestamp_now();
-    auto now = _time->now();
-    time_t local_as_utc = fields_to_epoch(
-        now.year, now.month, now.day_of_month,
-        now.hour, now.minute, now.second);
-    int32_t tz_offset = (int32_t)(local_as_utc - utc_now);
+  void RingClock::increment_hour()   { step_local_time(1, 0, "Hour"); }
+  void RingClock::increment_minute() { step_local_time(0, 1, "Minute"); }
 
-    // Increment minute with wrapping (0-59)
-    now.minute = (now.minute + 1) % 60;
-    now.second = 0;
+  // --- Time Buttons ---
 
-    time_t entered_utc = fields_to_epoch(now.year, now.month, now.day_of_month, now.hour, now.minute, now.second);
-    time_t utc_epoch   = entered_utc - tz_offset;
+  void RingClock::handle_time_buttons() {
+    ButtonInput in;
+    _buttons.poll(&in);
 
-    struct timeval tv = { .tv_sec = utc_epoch, .tv_usec = 0 };
-    settimeofday(&tv, NULL);
-    set_sntp_enabled(false);
-    ESP_LOGI(TAG, "Minute incremented (isolated, wrapped).");
+    // On the stopwatch face the buttons drive the stopwatch, dated to the
+    // press edge rather than to this poll.
+    if (_state == state::stopwatch && !is_adjusting_time()) {
+      if (in.hour_pressed) {
+        const uint32_t at = edge_millis(in.hour_press_us);
+        if (_stopwatch_active) {
+          pause_stopwatch_at(at);
+        } else {
+          start_stopwatch_at(at);
+        }
+      }
+      if (in.minute_pressed) {
+        const uint32_t at = edge_millis(in.minute_press_us);
+        if (_stopwatch_active) {
+          lap_stopwatch_at(at);
+        } else {
+          reset_stopwatch_at(at);
+        }
+      }
+      in.hour_steps = in.minute_steps = 0;
+      in.released = false;
+    }
+
+    if (in.hour_steps || in.minute_steps) {
+      _adjust_h += in.hour_steps;
+      _adjust_m += in.minute_steps;
+      this->_on_time_step_callback_.call(in.repeat);
+    }
+
+    if (in.chord_started) {
+      // Steps from the first button of the chord were only a preview.
+      _adjust_h = _adjust_m = 0;
+      for (auto &hold : _chord_holds) hold.fired = false;
+      ESP_LOGI(TAG, "Button chord started");
+    }
+    for (auto &hold : _chord_holds) {
+      if (!hold.fired && !in.chord_ended && in.chord_held_ms >= hold.hold_ms) {
+        hold.fired = true;
+        hold.callback();
+      }
+    }
+    if (in.chord_ended) {
+      ESP_LOGI(TAG, "Button chord released after %u ms", (unsigned) in.chord_held_ms);
+      this->_on_chord_release_callback_.call(in.chord_held_ms);
+    }
+
+    if (in.released && is_adjusting_time()) {
+      // All steps of the press land in a single clock write.
+      char what[32];
+      snprintf(what, sizeof(what), "Time (%+dh %+dm)", (int) _adjust_h, (int) _adjust_m);
+      step_local_time(_adjust_h, _adjust_m, what);
+      _adjust_h = _adjust_m = 0;
+      this->_on_time_adjusted_callback_.call();
+    }
+  }
+
+  void RingClock::add_on_time_step_callback(std::function<void(bool)> callback) {
+    this->_on_time_step_callback_.add(std::move(callback));
+  }
+  void RingClock::add_on_time_adjusted_callback(std::function<void()> callback) {
+    this->_on_time_adjusted_callback_.add(std::move(callback));
+  }
+  void RingClock::add_on_chord_hold_callback(uint32_t hold_ms, std::function<void()> callback) {
+    _chord_holds.push_back({hold_ms, std::move(callback), false});
+  }
+  void RingClock::add_on_chord_release_callback(std::function<void(uint32_t)> callback) {
+    this->_on_chord_release_callback_.add(std::move(callback));
   }
 
   bool RingClock::should_sweep() {
@@ -447,7 +1484,55 @@ namespace ring_clock {
 
   // --- Rendering Dispatch ---
 
+  void RingClock::start_transition(light::AddressableLight & it) {
+    for (int i = 0; i < TOTAL_LEDS; i++) _xfade_from[i] = it[i].get();
+    _xfade_start_ms = millis();
+    _xfade_active = true;
+  }
+
+  void RingClock::blend_transition(light::AddressableLight & it) {
+    const uint32_t elapsed = _frame_ms - _xfade_start_ms;
+    if (elapsed >= _xfade_ms) {
+      _xfade_active = false;  // the incoming frame stands as rendered
+      return;
+    }
+    // 8.8 fixed point: a = 0 is all outgoing, 256 all incoming.
+    const uint32_t a = (elapsed << 8) / _xfade_ms;
+    const uint32_t ia = 256 - a;
+    for (int i = 0; i < TOTAL_LEDS; i++) {
+      const Color to = it[i].get();
+      const Color &from = _xfade_from[i];
+      it[i] = Color((from.r * ia + to.r * a) >> 8, (from.g * ia + to.g * a) >> 8,
+                    (from.b * ia + to.b * a) >> 8);
+    }
+  }
+
+  void RingClock::draw_now() {
+    if (_clock_lights == nullptr || millis() - _frame_call_ms >= EFFECT_IDLE_MS) return;
+    auto *out = static_cast<light::AddressableLight *>(_clock_lights->get_output());
+    const uint32_t effect_ms = _frame_call_ms;  // only the effect keeps this alive
+    addressable_lights_lambdacall(*out);
+    _frame_call_ms = effect_ms;
+    out->schedule_show();
+  }
+
   IRAM_ATTR void RingClock::addressable_lights_lambdacall(light::AddressableLight & it) {
+    // Only fade from a frame the effect actually put on the rings.
+    const bool was_running = _first_frame_done && millis() - _frame_call_ms < EFFECT_IDLE_MS;
+    _frame_call_ms = millis();
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+    _trace.note_frame(was_running);
+#endif
+    // Calibration writes the frame directly; leave it alone.
+    if (_cal_phase != CalPhase::IDLE) return;
+
+    // A blanked frame is still on the rings: read the sensor before it is
+    // replaced, then force a full render to restore the hidden pixels.
+    if (_ambient_phase == AmbientPhase::BLANKED) {
+      ambient_sample_and_restore(nullptr);
+      _cache_m = -1;
+    }
+
     // Skip rendering if nothing has changed.
     const bool rain_h = hour_hand_color   && hour_hand_color->get_effect_name()   == "Rainbow";
     const bool rain_m = minute_hand_color && minute_hand_color->get_effect_name() == "Rainbow";
@@ -457,23 +1542,51 @@ namespace ring_clock {
     const bool brightness_changing = (_brightness_target >= 0.0f)
                                   && (_brightness_current >= 0.0f)
                                   && (fabsf(_brightness_current - _brightness_target) > 0.002f);
-    const bool is_dynamic =
-        (_state == state::stopwatch)                          // sub-second elapsed counter
-     || (_state == state::timer && _timer_active)             // countdown + pulse animation
-     || (_alarm_active)                                       // sinf(millis()) pulse overlay
+    // Eco states: clock faces become static and only change once a minute.
+    const bool static_face = _eco_state != ECO_FULL && is_face_state(_state);
+    // Distant viewers: clock faces change once a second, anything that still
+    // animates is drawn at most every _detail_far_interval_ms.
+    const bool far_face = !static_face && _detail == DETAIL_FAR && is_face_state(_state);
+    if (_xfade_ms > 0 && was_running
+        && (_xfade_requested || _state != _cache_mode || _face_index != _cache_face
+            || static_face != _cache_static || far_face != _cache_far)) {
+      start_transition(it);
+    }
+    _xfade_requested = false;
+    const bool is_dynamic = static_face
+      ? (_overlays.is_animated() || brightness_changing)
+      : far_face
+      ? (_xfade_active
+         || ((_overlays.is_animated() || brightness_changing)
+             && millis() - _frame_ms >= _detail_far_interval_ms))
+      : ((_state == state::stopwatch)                         // sub-second elapsed counter
+     || (_state == state::timer
+         && (!_timers.empty() || _timer_pulse_mask))          // countdown + pulse animation
+     || _overlays.is_animated()                               // alarm / timer pulse overlays
      || (rain_h || rain_m || rain_s)                          // HSV cycle changes every frame
      || (_state == state::time_fade)                          // millis()-driven fade progress
      || (_state == state::time_tail)                          // moving 15-LED tail
-     || brightness_changing;                                  // smooth brightness transition
-
-    // Fetch time once here; pass it into sub-renderers to avoid a second RTC read.
-    esphome::ESPTime now = this->_time->now();
+     || (_state == state::custom_face && _face_index >= 0
+         && FaceProgram::is_animated(_faces[_face_index].code)) // second / phase bindings
+     || brightness_changing                                   // smooth brightness transition
+     || _xfade_active);                                       // crossfade in progress
+
+    // Fetch time once here from the incremental cache (no localtime_r on the
+    // common path); pass it into sub-renderers to avoid a second read.
+    // While a time button is held the face shows the time it will set.
+    if (is_adjusting_time()) {
+      _adjust_preview = ESPTime::from_epoch_local(stepped_utc(_adjust_h, _adjust_m));
+    }
+    const esphome::ESPTime &now = is_adjusting_time() ? _adjust_preview
+                                                      : this->_local_time.now().local;
 
     if (!is_dynamic
-        && now.second == _cache_s
+        && (static_face || now.second == _cache_s)
         && now.minute == _cache_m
         && now.hour   == _cache_h
-        && _state     == _cache_mode) {
+        && _state     == _cache_mode
+        && _face_index == _cache_face
+        && _ambient_phase != AmbientPhase::REQUESTED) {
       return;  // Nothing changed — skip RMT write entirely (~98% of frames)
     }
 
@@ -482,56 +1595,122 @@ namespace ring_clock {
     _cache_m    = now.minute;
     _cache_h    = now.hour;
     _cache_mode = _state;
+    _cache_face = _face_index;
+    _cache_static = static_face;
+    _cache_far = far_face;
+
+    _frame_ms = millis();
+    render_frame(it, _state, now, static_face, far_face);
+    if (_xfade_active) blend_transition(it);
+#ifdef USE_RING_CLOCK_FRAME_OVERLAY
+    _overlay.blend(it);
+#endif
+    if (!_first_frame_done) note_first_frame();
 
-    switch (_state) {
-      case state::time:
-      case state::alarm:
-        render_time(it, false, now);
-        break;
-      case state::time_fade:
-        render_time(it, true, now);
-        break;
-      case state::time_tail:
-        render_tail(it, now);
-        break;
-      case state::timer:
-        render_timer(it);
-        break;
-      case state::stopwatch:
-        render_stopwatch(it);
-        break;
-      case state::sensors_bars:
-        render_sensors_bars(it);
-        break;
-      case state::sensors_temp_bar:
-        render_sensors_bar_individual(it, true);
-        break;
-      case state::sensors_humid_bar:
-        render_sensors_bar_individual(it, false);
-        break;
-      case state::sensors_temp_glow:
-        render_sensors_temp_glow(it);
-        break;
-      case state::sensors_humid_glow:
-        render_sensors_humid_glow(it);
-        break;
-      case state::sensors_dual_glow:
-        render_sensors_dual_glow(it);
-        break;
-      case state::sensors_ticks:
-        render_sensors_ticks(it);
-        break;
-      case state::sensors_temp_tick:
-        render_sensors_tick_individual(it, true);
-        break;
-      case state::sensors_humid_tick:
-        render_sensors_tick_individual(it, false);
-        break;
+    // Interference estimate for the ambient light sensor.
+    // Uses the two LEDs physically closest to the sensor on the PCB.
+    {
+      auto c_r1 = it[SENSOR_ADJACENT_LED_R1].get();
+      auto c_r2 = it[R1_NUM_LEDS + SENSOR_ADJACENT_LED_R2].get();
+      float b_r1 = (c_r1.r + c_r1.g + c_r1.b) / 3.0f;
+      float b_r2 = (c_r2.r + c_r2.g + c_r2.b) / 3.0f;
+      this->_interference_factor = (b_r1 + b_r2) / (2.0f * 255.0f);
     }
 
-    // Overlay: Alarm animation (pulsing ring) — drawn on top of whatever state is active
-    if (_alarm_active) {
-      render_alarm(it);
+    // Live preview: a single timestamp check unless a client is polling.
+    if (_preview != nullptr) {
+      _preview->capture(it, _frame_ms);
+    }
+
+    // Synchronised ambient sampling: this frame goes out with the LEDs around
+    // the sensor dark; loop() reads the ADC once it is on the rings.
+    if (_ambient_phase == AmbientPhase::REQUESTED) {
+      ambient_blank(it);
+    }
+
+    // Calibrated leakage of exactly the frame being sent (after blanking).
+    _interference_mv = _imap.estimate_mv(it);
+
+    // Emitted power for the self-heating model.
+    if (_raw_temp != nullptr) {
+      _led_power_w = ThermalModel::frame_power_w(it, _channel_full_w);
+    }
+  }
+
+  IRAM_ATTR void RingClock::render_frame(light::AddressableLight & it, state mode,
+                                         const esphome::ESPTime & now, bool static_face,
+                                         bool far_face) {
+    if (static_face && is_face_state(mode)) {
+      render_static_face(it, now);
+    } else if (far_face && is_face_state(mode)) {
+      render_far_face(it, now);
+    } else {
+      switch (mode) {
+        case state::time:
+        case state::alarm:
+          render_time(it, false, now);
+          break;
+        case state::time_fade:
+          render_time(it, true, now);
+          break;
+        case state::time_tail:
+          render_tail(it, now);
+          break;
+        case state::timer:
+          render_timer(it);
+          break;
+        case state::stopwatch:
+          render_stopwatch(it);
+          break;
+        case state::sensors_bars:
+          render_sensors_bars(it);
+          break;
+        case state::sensors_temp_bar:
+          render_sensors_bar_individual(it, true);
+          break;
+        case state::sensors_humid_bar:
+          render_sensors_bar_individual(it, false);
+          break;
+        case state::sensors_temp_glow:
+          render_sensors_temp_glow(it);
+          break;
+        case state::sensors_humid_glow:
+          render_sensors_humid_glow(it);
+          break;
+        case state::sensors_dual_glow:
+          render_sensors_dual_glow(it);
+          break;
+        case state::sensors_ticks:
+          render_sensors_ticks(it);
+          break;
+        case state::sensors_temp_tick:
+          render_sensors_tick_individual(it, true);
+          break;
+        case state::sensors_humid_tick:
+          render_sensors_tick_individual(it, false);
+          break;
+        case state::sensors_temp_trend:
+          render_sensors_trend(it, true);
+          break;
+        case state::sensors_humid_trend:
+          render_sensors_trend(it, false);
+          break;
+        case state::custom_face:
+          render_custom_face(it, now);
+          break;
+      }
+    }
+
+    // Overlays (alarm, finished timers, posted from YAML / API) on top of
+    // whatever state is active, lowest priority first.
+    if (!_overlays.empty()) {
+      Color colors[FACE_COLOR_SOURCES];
+      resolve_bound_colors(now, colors);
+      // Keep pulses visible while the notification light is off.
+      if (this->notification_color == nullptr || !this->notification_color->current_values.get_state()) {
+        colors[FACE_COLOR_NOTIFICATION] = Color(255, 255, 255);
+      }
+      _overlays.composite(it, _frame_ms, colors);
     }
 
     // Overlay: Blank LEDs (hardware masking for obstruction/wiring)
@@ -541,16 +1720,6 @@ namespace ring_clock {
           it[idx] = Color(0, 0, 0);
       }
     }
-
-    // Interference estimate for the ambient light sensor.
-    // Uses the two LEDs physically closest to the sensor on the PCB.
-    {
-      auto c_r1 = it[SENSOR_ADJACENT_LED_R1].get();
-      auto c_r2 = it[R1_NUM_LEDS + SENSOR_ADJACENT_LED_R2].get();
-      float b_r1 = (c_r1.r + c_r1.g + c_r1.b) / 3.0f;
-      float b_r2 = (c_r2.r + c_r2.g + c_r2.b) / 3.0f;
-      this->_interference_factor = (b_r1 + b_r2) / (2.0f * 255.0f);
-    }
   }
 
   void RingClock::draw_markers(light::AddressableLight & it) {
@@ -569,6 +1738,8 @@ namespace ring_clock {
         else if (effect == "Sensors: Temperature Tick") { render_sensors_tick_individual(it, true);  sensor_effect_active = true; }
         else if (effect == "Sensors: Humidity Tick")    { render_sensors_tick_individual(it, false); sensor_effect_active = true; }
         else if (effect == "Sensors: Dual Glow")        { render_sensors_dual_glow(it);          sensor_effect_active = true; }
+        else if (effect == "Sensors: Temperature Trend") { render_sensors_trend(it, true);       sensor_effect_active = true; }
+        else if (effect == "Sensors: Humidity Trend")   { render_sensors_trend(it, false);       sensor_effect_active = true; }
       }
     }
 
@@ -640,7 +1811,7 @@ namespace ring_clock {
     // Override second Rainbow: use a drifting phase unrelated to clock position
     // so it doesn't always appear red at 12 o'clock
     if (second_hand_color != nullptr && second_hand_color->get_effect_name() == "Rainbow") {
-      float cycle = fmod(millis() / 47000.0f, 1.0f);
+      float cycle = fmod(_frame_ms / 47000.0f, 1.0f);
       float r, g, b;
       esphome::hsv_to_rgb(cycle * 360.0f, 1.0f, 1.0f, r, g, b);
       float br = second_hand_color->current_values.get_brightness();
@@ -653,9 +1824,9 @@ namespace ring_clock {
       if (fade) {
         if (this->last_second != now.second) {
           this->last_second = now.second;
-          this->last_second_timestamp = millis();
+          this->last_second_timestamp = _frame_ms;
         }
-        float progress = std::min((millis() - this->last_second_timestamp) / 1000.0f, 1.0f);
+        float progress = std::min((_frame_ms - this->last_second_timestamp) / 1000.0f, 1.0f);
         draw_fade(it, now.second + progress, sc);
       } else {
         it[now.second] = sc;
@@ -665,6 +1836,42 @@ namespace ring_clock {
     it[now.minute] = mc;
   }
 
+  // Eco face: no second hand, no tail, no sub-minute colour drift. Rainbow
+  // hands take their hue from the start of the minute.
+  void RingClock::render_static_face(light::AddressableLight & it, const esphome::ESPTime & now) {
+    clear_R1(it);
+    clear_R2(it);
+    draw_markers(it);
+
+    esphome::ESPTime minute_start = now;
+    minute_start.second = 0;
+    Color hc = resolve_hand_color(hour_hand_color,   _default_hour_color,   minute_start);
+    Color mc = resolve_hand_color(minute_hand_color, _default_minute_color, minute_start, true);
+
+    draw_hour_hand(it, hc, minute_start);
+    it[now.minute] = mc;
+  }
+
+  // Distant-viewer face: nothing moves between seconds and the hands are
+  // wide, without the sub-LED blending that washes out from across a room.
+  void RingClock::render_far_face(light::AddressableLight & it, const esphome::ESPTime & now) {
+    clear_R1(it);
+    clear_R2(it);
+    draw_markers(it);
+
+    Color hc = resolve_hand_color(hour_hand_color,   _default_hour_color,   now);
+    Color mc = resolve_hand_color(minute_hand_color, _default_minute_color, now, true);
+    Color sc = resolve_hand_color(second_hand_color, _default_second_color, now);
+
+    it[R1_NUM_LEDS + ((now.hour % 12) * 4)] = hc;
+    if (second_hand_color != nullptr && second_hand_color->current_values.get_state()) {
+      it[now.second] = sc;
+    }
+    for (int d = -1; d <= 1; d++) {
+      it[(now.minute + d + R1_NUM_LEDS) % R1_NUM_LEDS] = mc;
+    }
+  }
+
   IRAM_ATTR void RingClock::render_tail(light::AddressableLight & it, const esphome::ESPTime & now) {
     clear_R1(it);
     clear_R2(it);
@@ -680,14 +1887,14 @@ namespace ring_clock {
     if (second_hand_color != nullptr && second_hand_color->current_values.get_state()) {
       if (this->last_second != now.second) {
         this->last_second = now.second;
-        this->last_second_timestamp = millis();
+        this->last_second_timestamp = _frame_ms;
       }
-      float progress = std::min((millis() - this->last_second_timestamp) / 1000.0f, 1.0f);
+      float progress = std::min((_frame_ms - this->last_second_timestamp) / 1000.0f, 1.0f);
       float precise_pos = now.second + progress;
 
       std::string s_eff = second_hand_color->get_effect_name().str();
       if (s_eff == "Rainbow") {
-        float cycle_offset = fmod(millis() / 47000.0f, 1.0f) * 360.0f;
+        float cycle_offset = fmod(_frame_ms / 47000.0f, 1.0f) * 360.0f;
         float br = second_hand_color->current_values.get_brightness();
         int tail_length = 15;
         for (int i = 0; i < 60; i++) {
@@ -968,6 +2175,50 @@ namespace ring_clock {
     }
   }
 
+  void RingClock::render_sensors_trend(light::AddressableLight & it, bool is_temp) {
+#ifdef USE_RING_CLOCK_HISTORY
+    const int ch = is_temp ? 0 : 1;
+    float *pts = _trend[ch];
+    if (_trend_rev[ch] != _history.get_revision()) {
+      _trend_rev[ch] = _history.get_revision();
+      const uint32_t span_s = std::max<uint32_t>(_history.get_duration_s() / TREND_POINTS, 1);
+      _history.trend(is_temp ? HISTORY_TEMPERATURE : HISTORY_HUMIDITY, _history.get_end_utc(),
+                     span_s, TREND_POINTS, pts);
+    }
+
+    float lo = INFINITY, hi = -INFINITY;
+    for (int k = 0; k < TREND_POINTS; k++) {
+      if (std::isnan(pts[k])) continue;
+      lo = std::min(lo, pts[k]);
+      hi = std::max(hi, pts[k]);
+    }
+    if (lo > hi) return;  // nothing recorded yet
+    const float min_range = is_temp ? TREND_MIN_RANGE_TEMP : TREND_MIN_RANGE_HUMID;
+    if (hi - lo < min_range) {
+      const float mid = (hi + lo) / 2.0f;
+      lo = mid - min_range / 2.0f;
+      hi = mid + min_range / 2.0f;
+    }
+
+    Color nc = get_cv_color(this->notification_color->current_values);
+    int count = 0;
+    for (int h = 0; h < 12; h++) {
+      for (int s = 1; s <= 3; s++, count++) {
+        const float v = pts[count];
+        if (std::isnan(v)) continue;
+        // Keep the lowest point visible.
+        const float level = 0.15f + 0.85f * (v - lo) / (hi - lo);
+        Color c = is_temp ? get_temp_color(v) : get_humid_color(v);
+        it[R1_NUM_LEDS + (h * 4) + s] = Color(
+          (uint8_t)(c.r * nc.r / 255.0f * level), (uint8_t)(c.g * nc.g / 255.0f * level),
+          (uint8_t)(c.b * nc.b / 255.0f * level));
+      }
+    }
+#else
+    render_sensors_bar_individual(it, is_temp);
+#endif
+  }
+
   void RingClock::render_sensors_bar_individual(light::AddressableLight & it, bool is_temp) {
     float val = is_temp
       ? (_temp_sensor     ? _temp_sensor->state     : 20.0f)
@@ -996,61 +2247,70 @@ namespace ring_clock {
     clear_R1(it);
     clear_R2(it);
     draw_markers(it);
-    if (!_timer_active) return;
 
-    long remaining_ms = (long)_timer_target_ms - (long)millis();
-    if (remaining_ms < 0) remaining_ms = 0;
-    int total_seconds = remaining_ms / 1000;
-    int hours   = total_seconds / 3600;
-    int minutes = (total_seconds % 3600) / 60;
-    int seconds = total_seconds % 60;
-
-    if (total_seconds > 0 && total_seconds < 60) {
-      Color sc = (second_hand_color && second_hand_color->current_values.get_state())
-        ? get_cv_color(second_hand_color->current_values) : _default_second_color;
-      for (int i = 0; i < seconds; i++) it[i] = sc;
-    } else if (total_seconds > 0) {
-      Color hc = (hour_hand_color && hour_hand_color->current_values.get_state())
-        ? get_cv_color(hour_hand_color->current_values) : _default_hour_color;
-      for (int i = 0; i < 12 && i < hours; i++) it[R1_NUM_LEDS + (i * 4)] = hc;
+    // More than one timer in play (running or pulsing): each timer gets its
+    // own quadrant of R2 and R1 counts down whichever expires next.
+    int in_play = _timers.size();
+    for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+      if ((_timer_pulse_mask & (1 << id)) && _timers.find(id) == nullptr) in_play++;
+    }
+    const bool arcs = in_play > 1;
+
+    const TimerSlot *next = _timers.peek();
+    if (next != nullptr) {
+      int32_t remaining_ms = (int32_t)(next->deadline_ms - _frame_ms);
+      if (remaining_ms < 0) remaining_ms = 0;
+      int total_seconds = remaining_ms / 1000;
+      int hours   = total_seconds / 3600;
+      int minutes = (total_seconds % 3600) / 60;
+      int seconds = total_seconds % 60;
+
+      if (total_seconds > 0 && total_seconds < 60) {
+        Color sc = (second_hand_color && second_hand_color->current_values.get_state())
+          ? get_cv_color(second_hand_color->current_values) : _default_second_color;
+        for (int i = 0; i < seconds; i++) it[i] = sc;
+      } else if (total_seconds > 0) {
+        if (!arcs) {
+          Color hc = (hour_hand_color && hour_hand_color->current_values.get_state())
+            ? get_cv_color(hour_hand_color->current_values) : _default_hour_color;
+          for (int i = 0; i < 12 && i < hours; i++) it[R1_NUM_LEDS + (i * 4)] = hc;
+        }
 
-      Color mc = (minute_hand_color && minute_hand_color->current_values.get_state())
-        ? get_cv_color(minute_hand_color->current_values) : _default_minute_color;
-      for (int i = 0; i < minutes; i++) it[i] = mc;
+        Color mc = (minute_hand_color && minute_hand_color->current_values.get_state())
+          ? get_cv_color(minute_hand_color->current_values) : _default_minute_color;
+        for (int i = 0; i < minutes; i++) it[i] = mc;
 
-      Color sc = (second_hand_color && second_hand_color->current_values.get_state())
-        ? get_cv_color(second_hand_color->current_values) : _default_second_color;
-      it[seconds] = sc;
+        Color sc = (second_hand_color && second_hand_color->current_values.get_state())
+          ? get_cv_color(second_hand_color->current_values) : _default_second_color;
+        it[seconds] = sc;
+      }
     }
 
-    if (total_seconds == 0 && _timer_active) {
-      if (_timer_finished_ms == 0) _timer_finished_ms = millis();
+    // Finish pulses are overlays, see refresh_timer_pulses().
+    if (arcs) render_timer_arcs(it);
+  }
 
-      if (!_timer_finishing_dispatched) {
-        this->on_timer_finished();
-        _timer_finishing_dispatched = true;
-      }
+  // Concurrent timers on R2: timer n owns the quadrant starting at hour 3n.
+  // Its first 11 LEDs fill in proportion to the time left (the 12th is a
+  // separator); a finished timer's quadrant is left to its pulse overlay.
+  void RingClock::render_timer_arcs(light::AddressableLight & it) {
+    static const int QUADRANT = R2_NUM_LEDS / MAX_TIMERS;
+    const uint32_t now_ms = _frame_ms;
 
-      // Pulse the notification ring for configured duration, then clean up
-      uint32_t elapsed_finish = millis() - _timer_finished_ms;
-      if (elapsed_finish < ALARM_VISUAL_DURATION_MS) {
-        float pulse = 0.3f + 0.7f * ((sinf(millis() * 0.003f) + 1.0f) / 2.0f);
-        // Use notification_color if on; fall back to white so the pulse
-        // is always visible in default clock mode (notification is off).
-        Color nc = (this->notification_color != nullptr
-                    && this->notification_color->current_values.get_state())
-          ? get_cv_color(this->notification_color->current_values)
-          : Color(255, 255, 255);
-        Color pc = Color((uint8_t)(nc.r * pulse), (uint8_t)(nc.g * pulse), (uint8_t)(nc.b * pulse));
-        for (int i = 0; i < 12; i++) {
-          int base = R1_NUM_LEDS + (i * 4);
-          it[base + 1] = pc; it[base + 2] = pc; it[base + 3] = pc;
-        }
-      } else {
-        // Finished animation complete — reset timer state and return to clock
-        _timer_active = false;
-        _state = state::time;
-      }
+    for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+      const int base = R1_NUM_LEDS + id * QUADRANT;
+      const Color tc = DEFAULT_TIMER_COLORS[id];
+
+      if (_timer_pulse_mask & (1 << id)) continue;
+
+      const TimerSlot *t = _timers.find(id);
+      if (t == nullptr || t->duration_ms == 0) continue;
+
+      int32_t remaining_ms = (int32_t)(t->deadline_ms - now_ms);
+      if (remaining_ms < 0) remaining_ms = 0;
+      // Round up so a timer with any time left keeps at least one LED lit.
+      int lit = (int)(((uint64_t)remaining_ms * (QUADRANT - 1) + t->duration_ms - 1) / t->duration_ms);
+      for (int j = 0; j < lit; j++) it[base + j] = tc;
     }
   }
 
@@ -1060,7 +2320,7 @@ namespace ring_clock {
     draw_markers(it);
 
     uint32_t elapsed_ms = _stopwatch_active
-      ? (millis() - _stopwatch_start_ms)
+      ? (_frame_ms - _stopwatch_start_ms)
       : _stopwatch_paused_ms;
     if (elapsed_ms >= (uint32_t)(12 * 3600 * 1000)) elapsed_ms = 12 * 3600 * 1000 - 1;
 
@@ -1069,7 +2329,7 @@ namespace ring_clock {
     int minutes = (total_seconds % 3600) / 60;
     int seconds = total_seconds % 60;
 
-    if (minutes != _stopwatch_last_minute && _stopwatch_active) {
+    if (minutes != _stopwatch_last_minute && _stopwatch_active && !_replaying) {
       if (_stopwatch_last_minute != -1) this->on_stopwatch_minute();
       _stopwatch_last_minute = minutes;
     }
@@ -1083,34 +2343,65 @@ namespace ring_clock {
 
     for (int i = 0; i < 12 && i < hours;   i++) it[R1_NUM_LEDS + (i * 4)] = hc;
     for (int i = 0; i < minutes; i++) it[i] = mc;
+    // Where the seconds hand was at the last lap.
+    if (_laps.total() > 0) {
+      const Color lc = (this->notification_color != nullptr
+                        && this->notification_color->current_values.get_state())
+        ? get_cv_color(this->notification_color->current_values)
+        : Color(96, 96, 96);
+      it[(_laps.get(0).split_ms / 1000) % 60] = lc;
+    }
     it[seconds] = sc;
   }
 
-  void RingClock::render_alarm(light::AddressableLight & it) {
-    float pulse = 0.3f + 0.7f * ((sinf(millis() * 0.003f) + 1.0f) / 2.0f);
-    // Use notification_color if on; fall back to white so the alarm
-    // pulse is always visible in default clock mode (notification is off).
-    Color nc = (this->notification_color != nullptr
-                && this->notification_color->current_values.get_state())
-      ? get_cv_color(this->notification_color->current_values)
-      : Color(255, 255, 255);
-    Color pc = Color((uint8_t)(nc.r * pulse), (uint8_t)(nc.g * pulse), (uint8_t)(nc.b * pulse));
-    for (int i = 0; i < 12; i++) {
-      int base = R1_NUM_LEDS + (i * 4);
-      it[base + 1] = pc; it[base + 2] = pc; it[base + 3] = pc;
+  // Sub-second hand positions and the light colours feed the program; it
+  // draws the whole frame.
+  IRAM_ATTR void RingClock::render_custom_face(light::AddressableLight & it, const esphome::ESPTime & now) {
+    if (_face_index < 0) {
+      clear_R1(it);
+      clear_R2(it);
+      return;
     }
+    if (this->last_second != now.second) {
+      this->last_second = now.second;
+      this->last_second_timestamp = _frame_ms;
+    }
+    const float progress = std::min((_frame_ms - this->last_second_timestamp) / 1000.0f, 1.0f);
+
+    FaceInputs in;
+    in.second = (now.second + progress) / 60.0f;
+    in.minute = (now.minute + in.second) / 60.0f;
+    in.hour = ((now.hour % 12) + in.minute) / 12.0f;
+    in.hour24 = (now.hour + in.minute) / 24.0f;
+    in.ms = _frame_ms;
+    resolve_bound_colors(now, in.colors);
+    FaceProgram::run(_faces[_face_index].code, in, it);
+  }
+
+  void RingClock::resolve_bound_colors(const esphome::ESPTime & now, Color *out) {
+    out[FACE_COLOR_RGB] = Color(0, 0, 0);
+    out[FACE_COLOR_HOUR] = resolve_hand_color(hour_hand_color, _default_hour_color, now);
+    out[FACE_COLOR_MINUTE] = resolve_hand_color(minute_hand_color, _default_minute_color, now, true);
+    out[FACE_COLOR_SECOND] = resolve_hand_color(second_hand_color, _default_second_color, now);
+    out[FACE_COLOR_MARKER] = resolve_hand_color(marker_color, _default_marker_color, now);
+    out[FACE_COLOR_NOTIFICATION] = resolve_hand_color(notification_color, _default_notification_color, now);
   }
 
   // --- Trigger Constructors ---
   ReadyTrigger::ReadyTrigger(RingClock *parent)               { parent->add_on_ready_callback([this]()              { this->trigger(); }); }
-  TimerFinishedTrigger::TimerFinishedTrigger(RingClock *p)    { p->add_on_timer_finished_callback([this]()          { this->trigger(); }); }
+  TimerFinishedTrigger::TimerFinishedTrigger(RingClock *p)    { p->add_on_timer_finished_callback([this](uint8_t id){ this->trigger(id); }); }
   StopwatchMinuteTrigger::StopwatchMinuteTrigger(RingClock *p){ p->add_on_stopwatch_minute_callback([this]()        { this->trigger(); }); }
   AlarmTriggeredTrigger::AlarmTriggeredTrigger(RingClock *p)  { p->add_on_alarm_triggered_callback([this]()         { this->trigger(); }); }
-  TimerStartedTrigger::TimerStartedTrigger(RingClock *p)      { p->add_on_timer_started_callback([this]()           { this->trigger(); }); }
-  TimerStoppedTrigger::TimerStoppedTrigger(RingClock *p)      { p->add_on_timer_stopped_callback([this]()           { this->trigger(); }); }
+  TimerStartedTrigger::TimerStartedTrigger(RingClock *p)      { p->add_on_timer_started_callback([this](uint8_t id) { this->trigger(id); }); }
+  TimerStoppedTrigger::TimerStoppedTrigger(RingClock *p)      { p->add_on_timer_stopped_callback([this](uint8_t id) { this->trigger(id); }); }
   StopwatchStartedTrigger::StopwatchStartedTrigger(RingClock *p){ p->add_on_stopwatch_started_callback([this]()     { this->trigger(); }); }
   StopwatchPausedTrigger::StopwatchPausedTrigger(RingClock *p){ p->add_on_stopwatch_paused_callback([this]()        { this->trigger(); }); }
   StopwatchResetTrigger::StopwatchResetTrigger(RingClock *p)  { p->add_on_stopwatch_reset_callback([this]()         { this->trigger(); }); }
+  StopwatchLapTrigger::StopwatchLapTrigger(RingClock *p)      { p->add_on_stopwatch_lap_callback([this](uint16_t n, uint32_t lap, uint32_t split) { this->trigger(n, lap, split); }); }
+  TimeStepTrigger::TimeStepTrigger(RingClock *p)              { p->add_on_time_step_callback([this](bool r)        { this->trigger(r); }); }
+  TimeAdjustedTrigger::TimeAdjustedTrigger(RingClock *p)      { p->add_on_time_adjusted_callback([this]()          { this->trigger(); }); }
+  ChordHoldTrigger::ChordHoldTrigger(RingClock *p, uint32_t ms) { p->add_on_chord_hold_callback(ms, [this]()       { this->trigger(); }); }
+  ChordReleaseTrigger::ChordReleaseTrigger(RingClock *p)      { p->add_on_chord_release_callback([this](uint32_t ms) { this->trigger(ms); }); }
 
 } // namespace ring_clock
 } // namespace esphome
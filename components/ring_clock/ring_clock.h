@@ -1,32 +1,43 @@
 #pragma once
 
+#include "esphome/components/binary_sensor/binary_sensor.h"
 #include "esphome/components/light/addressable_light.h"
 #include "esphome/components/sensor/sensor.h"
 #include "esphome/components/switch/switch.h"
+#include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/components/time/real_time_clock.h"
+#include "esphome/components/web_server_base/web_server_base.h"
 #include "esphome/core/automation.h"
 #include "esphome/core/color.h"
 #include "esphome/core/component.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
+#include "face_program.h"
+#include "frame_overlay.h"
+#include "frame_preview.h"
+#include "interference_map.h"
+#include "lap_ring.h"
+#include "loop_trace.h"
+#include "net_worker.h"
+#include "overlay_stack.h"
+#include "phase_lock.h"
+#include "replay.h"
+#include "sensor_history.h"
+#include "settings_store.h"
+#include "ring_layout.h"
+#include "thermal_model.h"
+#include "time_buttons.h"
+#include "time_cache.h"
+#include "timer_manager.h"
+#include "tz_database.h"
+#include "warm_boot.h"
+#include "web_handler.h"
 #include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <string>
 #include <vector>
 
-// Hardware Definition
-// The clock consists of two rings of WS2812 LEDs
-// R1 (Inner Ring): 60 LEDs (Minutes/Seconds) - Indices 0-59
-// R2 (Outer Ring): 48 LEDs (Hours/Markers) - Indices 60-107
-#define TOTAL_LEDS 108
-#define R1_NUM_LEDS 60
-#define R2_NUM_LEDS 48
-
-// Indices of LEDs physically adjacent to the light sensor on the PCB.
-// Used to estimate LED interference when reading ambient brightness.
-// Update these if the PCB layout changes.
-#define SENSOR_ADJACENT_LED_R1 15 // Inner ring LED nearest the sensor
-#define SENSOR_ADJACENT_LED_R2                                                 \
-  12 // Outer ring LED nearest the sensor (R2-relative index)
-
 // Maximum timer duration: 12 h 59 m 59 s expressed in seconds
 #define TIMER_MAX_SECONDS 46799
 
@@ -47,6 +58,15 @@ static const Color DEFAULT_COLOR_SECOND(200, 200, 200);     // White
 static const Color DEFAULT_COLOR_NOTIFICATION(255, 145, 0); // Orange
 static const Color DEFAULT_COLOR_MARKERS(50, 50, 50);       // Dim White
 
+// Arc colours for concurrent timers, indexed by timer id.
+// Timer 0 matches the default hour hand colour.
+static const Color DEFAULT_TIMER_COLORS[MAX_TIMERS] = {
+    Color(255, 145, 0), // Orange
+    Color(0, 255, 255), // Cyan
+    Color(255, 0, 160), // Magenta
+    Color(120, 255, 0), // Lime
+};
+
 // Finite State Machine for the Clock's visual mode
 enum state {
   time,      // Standard clock display
@@ -57,8 +77,8 @@ enum state {
   // inside render_time / render_tail — it is not a separate FSM state.
   timer,     // Countdown timer visualization
   stopwatch, // Stopwatch visualization
-  alarm,     // Alarm active state (rendered as an overlay when _alarm_active is
-             // set)
+  alarm,     // Alarm active state (the pulse itself is an overlay, see
+             // OverlayStack)
 
   // Sensor visualizations
   sensors_bars,       // Dual bars: Temp (Right), Humid (Left)
@@ -70,6 +90,28 @@ enum state {
   sensors_humid_bar,  // Single full-circle bar for humidity
   sensors_temp_tick,  // Single tick for temperature
   sensors_humid_tick, // Single tick for humidity
+  sensors_temp_trend, // Temperature history sparkline around R2
+  sensors_humid_trend, // Humidity history sparkline around R2
+
+  custom_face, // Face compiled from YAML `faces:`, see set_face()
+};
+
+// Render fidelity chosen from room occupancy and light level.
+// In the eco states the clock faces drop to a static hours/minutes face
+// that only changes once a minute.
+enum EcoState : uint8_t {
+  ECO_FULL = 0,   // someone is present and the room is lit
+  ECO_VACANT = 1, // nobody present
+  ECO_DARK = 2,   // room is dark (takes precedence over vacant)
+  ECO_STATE_COUNT,
+};
+
+// Render level of detail chosen from the distance to the nearest radar
+// target. Far away the clock faces drop to a high-contrast face that only
+// changes once a second.
+enum RenderDetail : uint8_t {
+  DETAIL_NEAR = 0, // tail, fade and sub-LED motion
+  DETAIL_FAR = 1,  // wide hands, no sub-second motion
 };
 
 enum MarkerHighlightMode {
@@ -88,6 +130,8 @@ public:
   // --- Component Lifecycle ---
   void setup() override;
   void loop() override;
+  // Writes the warm-boot snapshot to NVS before a restart or OTA reboot.
+  void on_shutdown() override;
   void on_ready();
   void add_on_ready_callback(std::function<void()> callback);
 
@@ -99,6 +143,14 @@ public:
   state get_state();
   void set_state(state state);
 
+  // --- Transitions ---
+  // A change of state (or between full and eco faces) crossfades from the
+  // frame on the rings to the new face over `ms` (0 = instant cut).
+  void set_transition_length(uint32_t ms) { this->_xfade_ms = ms; }
+  // Crossfade on the next frame even though the state is unchanged, e.g.
+  // when an effect change restyles the hands.
+  void begin_transition() { this->_xfade_requested = true; }
+
   // --- Data Setters (Usually called from YAML) ---
   void set_time(time::RealTimeClock *time);
   void set_hour_sweep_switch(switch_::Switch *hour_sweep) {
@@ -127,6 +179,134 @@ public:
     this->_marker_highlight_mode = mode;
   }
 
+  // --- Eco Rendering ---
+  // Either input is optional. Presence restores full fidelity on the next
+  // frame; darkness uses dark_below with `hysteresis` to leave the state.
+  void set_eco_occupancy(binary_sensor::BinarySensor *occupancy) {
+    this->_eco_occupancy = occupancy;
+  }
+  void set_eco_light_sensor(sensor::Sensor *light, float dark_below,
+                            float hysteresis) {
+    this->_eco_light = light;
+    this->_eco_dark_below = dark_below;
+    this->_eco_hysteresis = hysteresis;
+  }
+  void set_eco_state_text_sensor(text_sensor::TextSensor *s) {
+    this->_eco_state_text = s;
+  }
+  void set_eco_time_sensor(EcoState s, sensor::Sensor *sens) {
+    this->_eco_time_sensors[s] = sens;
+  }
+  void set_eco_enabled(bool enabled);
+  EcoState get_eco_state() const { return this->_eco_state; }
+
+  // --- Render Detail ---
+  // Either sensor is optional; the nearer target counts. The far face is
+  // used beyond far_above and left below far_above - hysteresis, once the
+  // new level has held for switch_delay_ms. Eco states take precedence.
+  void set_detail_distance_sensors(sensor::Sensor *moving, sensor::Sensor *still) {
+    this->_detail_moving = moving;
+    this->_detail_still = still;
+  }
+  void set_detail_thresholds(float far_above, float hysteresis, uint32_t switch_delay_ms) {
+    this->_detail_far_above = far_above;
+    this->_detail_hysteresis = hysteresis;
+    this->_detail_switch_delay_ms = switch_delay_ms;
+  }
+  // Shortest time between far frames while something animates (overlays,
+  // brightness ramps); the face itself only changes once a second.
+  void set_detail_far_interval(uint32_t ms) { this->_detail_far_interval_ms = ms; }
+  void set_detail_state_text_sensor(text_sensor::TextSensor *s) {
+    this->_detail_state_text = s;
+  }
+  RenderDetail get_render_detail() const { return this->_detail; }
+
+  // --- Thermal Self-heating Compensation ---
+  // Publishes temperature/humidity corrected for the board's own heat, which
+  // is modelled from the LED power in the frame buffer (see ThermalModel).
+  void set_thermal_sensors(sensor::Sensor *raw_temperature,
+                           sensor::Sensor *raw_humidity,
+                           sensor::Sensor *temperature,
+                           sensor::Sensor *humidity) {
+    this->_raw_temp = raw_temperature;
+    this->_raw_humid = raw_humidity;
+    this->_comp_temp = temperature;
+    this->_comp_humid = humidity;
+  }
+  void configure_thermal_model(float base_rise_c, float led_coefficient,
+                               uint32_t time_constant_s, float channel_full_w) {
+    this->_thermal.configure(base_rise_c, led_coefficient, time_constant_s);
+    this->_channel_full_w = channel_full_w;
+  }
+  // User trims applied on top of the model (web UI numbers).
+  void set_temperature_trim(float c) { this->_temp_trim = c; }
+  void set_humidity_trim(float rh) { this->_humid_trim = rh; }
+  float get_self_heating() const { return this->_thermal.get_rise(); }
+  float get_led_power() const { return this->_led_power_w; }
+
+  // --- Sensor Interference Calibration ---
+  // Lights every LED channel in turn against a dark frame and stores the
+  // sensor rise per channel in NVS (about a minute; needs ambient_sampling
+  // and a dark, steady room). The rings show the sequence while it runs.
+  void start_interference_calibration();
+  void cancel_interference_calibration();
+  bool is_calibrating() const { return _cal_phase != CalPhase::IDLE; }
+  bool has_interference_map() const { return _imap.is_calibrated(); }
+  void clear_interference_map();
+  // Calibrated leakage of the frame currently on the rings, in sensor mV.
+  // Zero until calibrated. Subtract it from the raw ADC voltage.
+  float get_interference_mv() const { return _interference_mv; }
+
+  // --- Web Endpoints ---
+  // Routes are registered under /ring_clock/ on the existing web server,
+  // only when at least one endpoint is enabled.
+  void set_web_server_base(web_server_base::WebServerBase *base) {
+    this->_web_base = base;
+  }
+  void register_web_handler();
+  // Live LED preview at /ring_clock/frame, at most one frame per
+  // min_interval_ms while a client is polling.
+  void enable_frame_preview(uint32_t min_interval_ms);
+  FramePreview *get_frame_preview() { return this->_preview; }
+#ifdef USE_RING_CLOCK_LOCAL_ASSETS
+  // Web UI assets in flash (`local_assets:` in YAML) at
+  // /ring_clock/static/<name>, with ETags and max_age_s of caching.
+  void add_local_asset(const char *name, const char *content_type, const uint8_t *data, size_t len,
+                       const char *etag, bool gzipped) {
+    this->_assets.push_back({name, content_type, data, len, etag, gzipped});
+  }
+  void set_local_asset_max_age(uint32_t max_age_s) { this->_asset_max_age_s = max_age_s; }
+  uint32_t get_local_asset_max_age() const { return this->_asset_max_age_s; }
+  const LocalAsset *find_local_asset(const std::string &name) const {
+    for (const auto &a : this->_assets) {
+      if (name == a.name) return &a;
+    }
+    return nullptr;
+  }
+#endif
+
+  // --- Custom Faces ---
+  // Faces compiled from YAML (`faces:`), run by FaceProgram. Programs that
+  // fail validation are logged and never drawn.
+  void add_face(const char *name, const uint8_t *code, size_t len);
+  // Index for set_face(), or -1 if no face has that name.
+  int find_face(const std::string &name) const;
+  // Switches to state::custom_face showing face `index`; an unknown index
+  // draws dark rings.
+  void set_face(int index) {
+    this->_state = state::custom_face;
+    this->_face_index = index >= 0 && index < (int) this->_faces.size() ? index : -1;
+  }
+
+#ifdef USE_RING_CLOCK_HISTORY
+  // Sensor history (`history:` in YAML): sampled once a second, stored as
+  // one mean per interval, exported at /ring_clock/history.bin.
+  void configure_history(uint32_t interval_s, uint32_t duration_s) {
+    this->_history.configure(interval_s, duration_s);
+  }
+  SensorHistory *get_sensor_history() { return &this->_history; }
+#endif
+
   // API to define LEDs that should be turned off (hardware masking)
   void set_blank_leds(std::vector<int> leds);
 
@@ -134,17 +314,57 @@ public:
   // based on the brightness of LEDs physically near the sensor
   float get_interference_factor();
 
+  // --- Synchronised Ambient Sampling ---
+  // The component drives the light sensor's updates (set its
+  // update_interval to `never`): every interval the LEDs within `radius` of
+  // the sensor are blanked for one frame and the ADC is read while that
+  // frame is on the rings, then the pixels are restored.
+  // Takes the ADC sensor itself: it is polled as a PollingComponent and its
+  // unfiltered value is read as a Sensor during calibration.
+  template<typename T> void set_ambient_sensor(T *adc) {
+    this->_ambient_adc = adc;
+    this->_ambient_sensor = adc;
+  }
+  void set_ambient_interval(uint32_t ms) { this->_ambient_interval_ms = ms; }
+  void set_ambient_blank_radius(uint8_t radius) {
+    this->_ambient_radius = std::min<uint8_t>(radius, AMBIENT_MAX_RADIUS);
+  }
+
   // Set the target brightness for smooth transitions.
   // target : 0.0–1.0  — step smoothly toward this brightness.
   //         -1.0       — manual mode (HA slider controls brightness).
   void set_target_brightness(float target);
 
   // --- Timer Logic ---
+  // Up to MAX_TIMERS countdowns run concurrently, addressed by id
+  // (0 .. MAX_TIMERS-1). Starting an id that is already running re-arms it.
+  void start_timer(uint8_t timer_id, int hours, int minutes, int seconds);
+  void cancel_timer(uint8_t timer_id);
+  bool is_timer_running(uint8_t timer_id) const;
+  // Milliseconds left on a running timer, 0 if it is not running.
+  uint32_t get_timer_remaining_ms(uint8_t timer_id) const;
+  bool has_running_timers() const { return !_timers.empty(); }
+
+  // Legacy single-timer API: start_timer() drives timer 0,
+  // stop_timer() cancels every running timer and, as before, fires
+  // on_timer_stopped once (with timer_id 0) whether or not one was running.
   void start_timer(int hours, int minutes, int seconds);
   void stop_timer();
-  void on_timer_started();
-  void on_timer_stopped();
-  void on_timer_finished();
+
+  void on_timer_started(uint8_t timer_id);
+  void on_timer_stopped(uint8_t timer_id);
+  void on_timer_finished(uint8_t timer_id);
+
+  // --- Timezone Database ---
+  // Flash-resident IANA -> POSIX table generated at build time (optional).
+  void set_timezone_database(const uint8_t *data, size_t len) {
+    this->_tz_db.set_data(data, len);
+  }
+  // POSIX TZ rule for an IANA name such as "Europe/Berlin", or nullptr when
+  // the name is unknown or no database was compiled in. O(log n), no heap.
+  const char *lookup_timezone(const std::string &iana) const {
+    return this->_tz_db.lookup(iana.c_str());
+  }
 
   // --- Time Management API ---
   // Apply SNTP UTC epoch - gated by _sntp_enabled.
@@ -161,6 +381,102 @@ public:
   void increment_hour();
   void increment_minute();
 
+  // --- Time Buttons ---
+  // Native hour/minute button handling. While a button is held the face
+  // previews the adjusted time; the clock is written once, on release.
+  void set_time_buttons(InternalGPIOPin *hour, InternalGPIOPin *minute) {
+    this->_buttons.set_pins(hour, minute);
+  }
+  TimeButtons &get_time_buttons() { return _buttons; }
+  bool is_adjusting_time() const { return _adjust_h != 0 || _adjust_m != 0; }
+  // Fired per step; the argument is true for auto-repeat steps.
+  void add_on_time_step_callback(std::function<void(bool)> callback);
+  // Fired after the adjusted time has been written on release.
+  void add_on_time_adjusted_callback(std::function<void()> callback);
+  // Fired once when hour+minute have been held together for hold_ms.
+  void add_on_chord_hold_callback(uint32_t hold_ms, std::function<void()> callback);
+  // Fired when the chord is released, with the time it was held.
+  void add_on_chord_release_callback(std::function<void(uint32_t)> callback);
+
+  // Drop the cached local-time decomposition. Call after changing the
+  // timezone; clock steps are detected automatically. The new rule is also
+  // remembered for the fast-boot path.
+  void invalidate_local_time() {
+    this->_local_time.invalidate();
+    this->remember_timezone();
+  }
+
+  // --- Fast Boot ---
+  // setup() reads the hardware RTC and the last applied timezone itself and
+  // draws a static face before WiFi, API and web_server start. The light
+  // effect takes over from the next loop().
+  // The RTC component is moved ahead of this one in setup order (see
+  // __init__.py), so read_time() never runs before its own setup().
+  template<typename T> void set_boot_rtc(T *rtc) {
+    this->_boot_rtc_read = [rtc]() {
+      if (!rtc->is_failed()) rtc->read_time();
+    };
+  }
+  void set_first_frame_sensor(sensor::Sensor *s) { this->_first_frame_sensor = s; }
+  // Just after the light outputs, hand lights and the RTC, ahead of the
+  // sensors and the network stack; setup() therefore touches no network
+  // API, and the web endpoints are registered by RingClockWebSetup.
+  float get_setup_priority() const override { return setup_priority::HARDWARE - 2.0f; }
+
+#ifdef USE_RING_CLOCK_FRAME_OVERLAY
+  // --- UDP Frame Overlay (`frame_overlay:` in YAML) ---
+  // DDP or E1.31 pixel data blended over whatever the clock renders. A new
+  // overlay frame is drawn from loop() at once, not at the next effect
+  // update.
+  void set_frame_overlay(OverlayProtocol protocol, uint16_t port, uint16_t universe, bool rgba,
+                         uint32_t timeout_ms) {
+    this->_overlay.configure(protocol, port, universe, rgba, timeout_ms);
+  }
+  bool is_overlay_active() const { return this->_overlay.is_active(); }
+#endif
+
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+  // --- Main Loop Tracer (`loop_trace:` in YAML) ---
+  // Samples which component the main loop is in and how long LED frames
+  // wait for each other. Every publish interval the worst offenders go to
+  // the sensors below; /ring_clock/trace has totals since boot and the
+  // latest stalls and frame gaps.
+  void set_loop_trace(uint32_t sample_us, uint32_t stall_ms, uint32_t gap_ms, uint32_t publish_ms) {
+    this->_trace.configure(sample_us, stall_ms, gap_ms);
+    this->_trace_publish_interval_ms = publish_ms;
+  }
+  void set_trace_worst_component_text(text_sensor::TextSensor *s) { this->_trace_worst_text = s; }
+  void set_trace_worst_stall_sensor(sensor::Sensor *s) { this->_trace_worst_stall_sensor = s; }
+  void set_trace_frame_gap_sensor(sensor::Sensor *s) { this->_trace_frame_gap_sensor = s; }
+  void set_trace_loop_load_sensor(sensor::Sensor *s) { this->_trace_loop_load_sensor = s; }
+  LoopTracer *get_loop_tracer() { return &this->_trace; }
+#endif
+
+#ifdef USE_RING_CLOCK_NET_WORKER
+  // --- Background Network Fetches (`net_worker:` in YAML) ---
+  // GETs `url` on the worker task and picks up to four dotted JSON paths
+  // (e.g. "timezone.id") out of the response. `callback` runs later from
+  // loop() with the HTTP status (-1 on failure) and one value per field,
+  // empty where the field was missing. Returns false if the request could
+  // not be queued.
+  using FetchCallback = std::function<void(int status, const std::vector<std::string> &values)>;
+  bool fetch_json(const std::string &url, std::initializer_list<const char *> fields, FetchCallback callback);
+  void set_net_worker_max_body(uint32_t bytes) { this->_net.set_max_body(bytes); }
+  void set_net_worker_stack_size(uint32_t bytes) { this->_net.set_stack_size(bytes); }
+#endif
+
+#ifdef USE_RING_CLOCK_PHASE_LOCK
+  // --- LAN Phase Lock (`phase_lock:` in YAML) ---
+  // The leader multicasts a beacon at each rendered second; followers shift
+  // their rendered time so their seconds tick with it. Around each boundary
+  // loop() runs at full rate and draws the new second itself instead of
+  // waiting for the next effect update.
+  void set_phase_lock(PhaseRole role, const char *group, uint16_t port) {
+    this->_phase.configure(role, group, port);
+  }
+  void set_phase_error_sensor(sensor::Sensor *s) { this->_phase_error_sensor = s; }
+#endif
+
   // Control whether incoming SNTP syncs are applied to the system clock.
   // Safe to call at any time, including before network is available.
   void set_sntp_enabled(bool enabled);
@@ -170,29 +486,66 @@ public:
   // Applies any pending sntp_stop() that couldn't run at boot time.
   void set_network_ready();
 
-  void add_on_timer_started_callback(std::function<void()> callback);
-  void add_on_timer_stopped_callback(std::function<void()> callback);
-  void add_on_timer_finished_callback(std::function<void()> callback);
+  void add_on_timer_started_callback(std::function<void(uint8_t)> callback);
+  void add_on_timer_stopped_callback(std::function<void(uint8_t)> callback);
+  void add_on_timer_finished_callback(std::function<void(uint8_t)> callback);
 
   // --- Stopwatch Logic ---
-  void start_stopwatch();
-  void pause_stopwatch();
+  // The _at variants take the millis() of the input itself rather than of
+  // the call, e.g. a button edge dated in its interrupt handler, so
+  // debouncing and automations add no error. On the stopwatch face the
+  // hour/minute buttons (`buttons:`) use them: hour starts and pauses,
+  // minute takes a lap while running and resets while paused.
+  void start_stopwatch() { start_stopwatch_at(millis()); }
+  void pause_stopwatch() { pause_stopwatch_at(millis()); }
+  void reset_stopwatch() { reset_stopwatch_at(millis()); }
+  void lap_stopwatch() { lap_stopwatch_at(millis()); }
+  void start_stopwatch_at(uint32_t at_ms);
+  void pause_stopwatch_at(uint32_t at_ms);
+  void reset_stopwatch_at(uint32_t at_ms);
+  void lap_stopwatch_at(uint32_t at_ms);
   void stop_stopwatch();
-  void reset_stopwatch();
   void on_stopwatch_started();
   void on_stopwatch_paused();
   void on_stopwatch_reset();
   void on_stopwatch_minute();
+  bool is_stopwatch_running() const { return _stopwatch_active; }
+  // Newest laps first; see LapRing.
+  const LapRing &get_laps() const { return _laps; }
+  void set_last_lap_sensor(sensor::Sensor *s) { _last_lap_sensor = s; }
+  void set_best_lap_sensor(sensor::Sensor *s) { _best_lap_sensor = s; }
+  void set_lap_count_sensor(sensor::Sensor *s) { _lap_count_sensor = s; }
 
   void add_on_stopwatch_started_callback(std::function<void()> callback);
   void add_on_stopwatch_paused_callback(std::function<void()> callback);
   void add_on_stopwatch_reset_callback(std::function<void()> callback);
   void add_on_stopwatch_minute_callback(std::function<void()> callback);
+  void add_on_stopwatch_lap_callback(std::function<void(uint16_t, uint32_t, uint32_t)> callback);
 
   // --- Alarm Logic ---
   void start_alarm();
   void on_alarm_triggered();
   void add_on_alarm_triggered_callback(std::function<void()> callback);
+  bool is_alarm_active() const { return this->_overlays.find(OVERLAY_ID_ALARM) != nullptr; }
+
+  // --- Overlays ---
+  // Timed overlays drawn over every face, highest priority on top (see
+  // OverlayStack). The alarm and finished timers post their pulses here;
+  // YAML and API actions can post and cancel their own with ids from
+  // OVERLAY_ID_USER up (lower ids are refused), at priorities below
+  // OVERLAY_PRIORITY_ALARM. `regions` is a set of OverlayRegion bits;
+  // duration_ms 0 keeps the overlay until cancel_overlay(). Returns false
+  // if all slots hold overlays of the same or higher priority.
+  static constexpr uint16_t OVERLAY_ID_ALARM{1};
+  static constexpr uint16_t OVERLAY_ID_TIMER{2};  // + timer id
+  static constexpr uint16_t OVERLAY_ID_USER{16};
+  static constexpr uint8_t OVERLAY_PRIORITY_TIMER{150};
+  static constexpr uint8_t OVERLAY_PRIORITY_ALARM{200};
+  bool post_overlay(uint16_t id, uint8_t priority, uint8_t regions, Color color, uint32_t duration_ms,
+                    OverlayBlend blend = OVERLAY_REPLACE, OverlayPattern pattern = OVERLAY_SOLID);
+  // Any LED mask or colour source.
+  bool post_overlay(const Overlay &overlay, uint32_t duration_ms);
+  void cancel_overlay(uint16_t id);
 
   // --- Default Color Setters (Optional overrides) ---
   void set_default_hour_color(Color color) { _default_hour_color = color; }
@@ -203,6 +556,20 @@ public:
   }
   void set_default_marker_color(Color color) { _default_marker_color = color; }
 
+#ifdef USE_RING_CLOCK_REPLAY
+  // --- Time-warp Replay (debug builds, `replay:` in YAML) ---
+  // Renders span_s of simulated time from start_utc with face `mode` into an
+  // off-screen canvas, one frame per step_ms of simulated time, paced to take
+  // duration_ms of wall time (0 = as fast as the slice budget allows). The
+  // rings keep showing the live clock; the report is logged at the end.
+  void start_replay(state mode, time_t start_utc, uint32_t span_s,
+                    uint32_t step_ms, uint32_t duration_ms);
+  void stop_replay();
+  bool is_replay_running() const { return _replay.is_running(); }
+  const ReplayStats &get_replay_stats() const { return _replay.get_stats(); }
+  void set_replay_slice_budget(uint32_t us) { _replay_slice_budget_us = us; }
+#endif
+
   void add_temperature_color_point(float value, Color color) {
     _temp_color_points.push_back({value, color});
   }
@@ -244,6 +611,32 @@ protected:
   int last_second{-1};
   uint32_t last_second_timestamp{0};
 
+  // millis() of the frame being rendered. Renderers read this instead of
+  // calling millis() so a replay can drive them from a synthetic clock.
+  uint32_t _frame_ms{0};
+  // millis() of the light effect's last call into the lambda.
+  uint32_t _frame_call_ms{0};
+  // The effect counts as running if it called the lambda this recently.
+  static constexpr uint32_t EFFECT_IDLE_MS{1000};
+  // Render and send a frame from loop() instead of waiting for the next
+  // effect update. Does nothing while the effect is not driving the rings,
+  // so a light that is off stays off.
+  void draw_now();
+  // True while rendering replay frames: renderers must not fire callbacks.
+  bool _replaying{false};
+
+  // Draws one complete frame of face `mode` at local time `now`, including
+  // the alarm overlay and blanked LEDs. With static_face the clock faces
+  // are drawn without seconds (eco states), with far_face as the distant
+  // viewer face.
+  void render_frame(light::AddressableLight &it, state mode,
+                    const esphome::ESPTime &now, bool static_face = false,
+                    bool far_face = false);
+  // Markers, hour and minute hands only; colours are evaluated at the
+  // start of the minute so the frame is constant for 60 s.
+  void render_static_face(light::AddressableLight &it,
+                          const esphome::ESPTime &now);
+
   // --- Helpers ---
   void clear_R1(light::AddressableLight &it);
   void clear_R2(light::AddressableLight &it);
@@ -266,8 +659,19 @@ protected:
                    const esphome::ESPTime &now);
   void render_tail(light::AddressableLight &it, const esphome::ESPTime &now);
   void render_timer(light::AddressableLight &it);
+  void render_timer_arcs(light::AddressableLight &it);
   void render_stopwatch(light::AddressableLight &it);
-  void render_alarm(light::AddressableLight &it);
+
+  // --- Custom Faces ---
+  struct Face {
+    const char *name;
+    const uint8_t *code;
+  };
+  std::vector<Face> _faces;
+  int _face_index{-1};
+  void render_custom_face(light::AddressableLight &it, const esphome::ESPTime &now);
+  // Colours of the customisation lights, indexed by FaceColorSource.
+  void resolve_bound_colors(const esphome::ESPTime &now, Color *out);
 
   void render_sensors_bars(light::AddressableLight &it);
   void render_sensors_ticks(light::AddressableLight &it);
@@ -277,14 +681,36 @@ protected:
   void render_sensors_bar_individual(light::AddressableLight &it, bool is_temp);
   void render_sensors_tick_individual(light::AddressableLight &it,
                                       bool is_temp);
+  // Sensor history as a sparkline on the 36 non-marker R2 LEDs, oldest at
+  // 12 o'clock: colour is the value, brightness its level within the range
+  // shown. Needs `history:`; otherwise draws the plain bar.
+  void render_sensors_trend(light::AddressableLight &it, bool is_temp);
 
   bool should_sweep();
 
 private:
-  // Gregorian calendar fields -> Unix UTC epoch.
-  // Pure arithmetic: no libc TZ side-effects.
-  static time_t fields_to_epoch(int year, int month, int day, int hour,
-                                int minute, int second);
+  // Current local date with the hour and the minute each stepped in
+  // isolation (23 -> 0 keeps the date, 59 -> 0 keeps the hour) and the
+  // seconds zeroed, as a UTC epoch using the offset from the same snapshot.
+  time_t stepped_utc(int32_t hours, int32_t minutes);
+  // Writes stepped_utc() to the system clock. Used by the increment buttons.
+  void step_local_time(int32_t hours, int32_t minutes, const char *what);
+
+  // --- Time Buttons ---
+  void handle_time_buttons();
+  struct ChordHold {
+    uint32_t hold_ms;
+    std::function<void()> callback;
+    bool fired;
+  };
+  TimeButtons _buttons;
+  int32_t _adjust_h{0};
+  int32_t _adjust_m{0};
+  ESPTime _adjust_preview{};
+  std::vector<ChordHold> _chord_holds;
+  CallbackManager<void(bool)> _on_time_step_callback_;
+  CallbackManager<void()> _on_time_adjusted_callback_;
+  CallbackManager<void(uint32_t)> _on_chord_release_callback_;
 
   Color get_temp_color(float t);
   Color get_humid_color(float h);
@@ -293,11 +719,109 @@ private:
   void draw_fade(light::AddressableLight &it, float precise_pos, Color color);
 
   // --- Timer State ---
-  bool _timer_active{false};
-  uint32_t _timer_target_ms{0};
-  uint32_t _timer_duration_ms{0};
-  uint32_t _timer_finished_ms{0};
-  bool _timer_finishing_dispatched{false};
+  TimerHeap _timers;
+  // Bit n set while timer n is showing its finish pulse (an overlay).
+  uint8_t _timer_pulse_mask{0};
+  void refresh_timer_pulses();
+  // Cancels without firing on_timer_stopped; true if it was running.
+  bool remove_timer(uint8_t timer_id);
+
+  // --- Timezone Database ---
+  TimezoneDatabase _tz_db;
+
+  // --- Synchronised Ambient Sampling ---
+  static constexpr uint8_t AMBIENT_MAX_RADIUS{3};
+  // A blanked frame is on the LEDs once the RMT transfer (~3.5 ms for 108
+  // LEDs) has finished; wait a little longer before reading.
+  static constexpr uint32_t AMBIENT_SETTLE_MS{6};
+  // Give up waiting for a frame (effect not rendered by this component).
+  static constexpr uint32_t AMBIENT_FRAME_TIMEOUT_MS{500};
+  enum class AmbientPhase : uint8_t { IDLE, REQUESTED, BLANKED };
+  // LED index of the k-th pixel in the blanking window (R1 first, then R2).
+  int ambient_led(int k) const;
+  void ambient_blank(light::AddressableLight &it);
+  void ambient_sample_and_restore(light::AddressableLight *it);
+  PollingComponent *_ambient_adc{nullptr};
+  sensor::Sensor *_ambient_sensor{nullptr};
+  uint32_t _ambient_interval_ms{1000};
+  uint32_t _ambient_last_ms{0};
+  uint32_t _ambient_phase_ms{0};
+  uint8_t _ambient_radius{1};
+  AmbientPhase _ambient_phase{AmbientPhase::IDLE};
+  // Pixels hidden by the blanking frame: R1 window, then R2 window.
+  Color _ambient_saved[2 * (2 * AMBIENT_MAX_RADIUS + 1)];
+
+  // --- Eco Rendering ---
+  static constexpr uint32_t ECO_PUBLISH_MS{60000};
+  void update_eco_state();
+  void publish_eco_times(uint32_t now_ms);
+  bool is_face_state(state s) const {
+    return s == state::time || s == state::time_fade || s == state::time_tail;
+  }
+  binary_sensor::BinarySensor *_eco_occupancy{nullptr};
+  sensor::Sensor *_eco_light{nullptr};
+  float _eco_dark_below{0.0f};
+  float _eco_hysteresis{0.0f};
+  bool _eco_enabled{true};
+  bool _eco_is_dark{false};
+  EcoState _eco_state{ECO_FULL};
+  uint32_t _eco_since_ms{0};
+  uint32_t _eco_publish_ms{0};
+  uint64_t _eco_time_ms[ECO_STATE_COUNT]{};
+  text_sensor::TextSensor *_eco_state_text{nullptr};
+  sensor::Sensor *_eco_time_sensors[ECO_STATE_COUNT]{};
+
+  // --- Render Detail ---
+  void update_render_detail();
+  // Markers, hour hand on its hour, a 3-LED minute hand and a one-LED second
+  // hand; colours are evaluated per second.
+  void render_far_face(light::AddressableLight &it, const esphome::ESPTime &now);
+  sensor::Sensor *_detail_moving{nullptr};
+  sensor::Sensor *_detail_still{nullptr};
+  float _detail_far_above{250.0f};
+  float _detail_hysteresis{50.0f};
+  uint32_t _detail_switch_delay_ms{3000};
+  uint32_t _detail_far_interval_ms{200};
+  RenderDetail _detail{DETAIL_NEAR};
+  bool _detail_pending{false};  // the other level is indicated
+  uint32_t _detail_pending_ms{0};
+  text_sensor::TextSensor *_detail_state_text{nullptr};
+
+  // --- Thermal Self-heating Compensation ---
+  void publish_compensated_temperature(float raw);
+  void publish_compensated_humidity(float raw_rh);
+  ThermalModel _thermal;
+  sensor::Sensor *_raw_temp{nullptr};
+  sensor::Sensor *_raw_humid{nullptr};
+  sensor::Sensor *_comp_temp{nullptr};
+  sensor::Sensor *_comp_humid{nullptr};
+  float _channel_full_w{0.06f};
+  float _led_power_w{0.0f};  // of the last rendered frame
+  float _temp_trim{0.0f};
+  float _humid_trim{0.0f};
+  uint32_t _thermal_step_ms{0};
+
+  // --- Sensor Interference Calibration ---
+  // Sensor settle time after each frame change (CdS cells are slow to fall).
+  static constexpr uint32_t CAL_SETTLE_MS{80};
+  enum class CalPhase : uint8_t { IDLE, DARK, LIT };
+  void calibration_step(uint32_t now_ms);
+  void end_calibration();
+  InterferenceMap _imap;
+  float _interference_mv{0.0f};
+  CalPhase _cal_phase{CalPhase::IDLE};
+  uint16_t _cal_step{0};       // led * 3 + channel
+  uint32_t _cal_phase_ms{0};
+  float _cal_dark_v{0.0f};
+  uint8_t _cal_level{0};       // raw output of the lit channel
+
+  // --- Web Endpoints ---
+  web_server_base::WebServerBase *_web_base{nullptr};
+  FramePreview *_preview{nullptr};
+#ifdef USE_RING_CLOCK_LOCAL_ASSETS
+  std::vector<LocalAsset> _assets;
+  uint32_t _asset_max_age_s{86400};
+#endif
 
   // --- SNTP Sync Gate ---
   bool _sntp_enabled{true};
@@ -308,17 +832,146 @@ private:
   uint32_t _stopwatch_start_ms{0};
   uint32_t _stopwatch_paused_ms{0};
   int _stopwatch_last_minute{-1};
+  LapRing _laps;
+  sensor::Sensor *_last_lap_sensor{nullptr};
+  sensor::Sensor *_best_lap_sensor{nullptr};
+  sensor::Sensor *_lap_count_sensor{nullptr};
+  void publish_laps();
+
+  // --- Overlays ---
+  OverlayStack _overlays;
+  // post_overlay() without the id and priority checks, for the alarm.
+  bool push_overlay(const Overlay &overlay, uint32_t duration_ms);
 
   // --- Alarm State ---
-  bool _alarm_active{false};
   uint32_t _alarm_triggered_ms{0};
-  bool _alarm_dispatched{false};
+  void post_alarm_overlay(uint32_t duration_ms);
+
+  // --- Fast Boot ---
+  static constexpr size_t TZ_CACHE_LEN{64};
+  struct TimezoneCache {
+    char posix[TZ_CACHE_LEN];
+  };
+  void load_boot_time();
+  void draw_boot_frame();
+  void note_first_frame();
+  void remember_timezone();
+  std::function<void()> _boot_rtc_read;
+  sensor::Sensor *_first_frame_sensor{nullptr};
+  bool _first_frame_done{false};
+  bool _tz_pref_ready{false};
+  TimezoneCache _tz_cache{};
+  ESPPreferenceObject _tz_pref;
+
+  // --- Warm Boot ---
+  // Timers, stopwatch and alarm are re-expressed as UTC instants on every
+  // change and refreshed once a second so a clock step is tracked too.
+  // A snapshot found at boot is applied as soon as the time is valid.
+  static constexpr uint32_t WARM_BOOT_REFRESH_MS{1000};
+  // A timer that expired while the clock was down still rings if it is
+  // no more than this overdue; older ones are dropped silently.
+  static constexpr uint32_t WARM_BOOT_GRACE_MS{60000};
+  void save_warm_boot();
+  bool restore_warm_boot();
+  WarmBootStore _warm;
+  uint32_t _warm_refresh_ms{0};
+
+#ifdef USE_RING_CLOCK_PHASE_LOCK
+  // --- LAN Phase Lock ---
+  // High-frequency loop from this long before to this long after each
+  // rendered second boundary.
+  static constexpr uint16_t PHASE_WINDOW_MS{30};
+  static constexpr uint32_t PHASE_PUBLISH_MS{10000};
+  void phase_lock_step();
+  PhaseLock _phase;
+  HighFrequencyLoopRequester _phase_hf;
+  sensor::Sensor *_phase_error_sensor{nullptr};
+  time_t _phase_tick_s{0};
+  uint32_t _phase_publish_ms{0};
+  bool _phase_locked{false};
+#endif
+
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+  // --- Main Loop Tracer ---
+  void publish_loop_trace();
+  LoopTracer _trace;
+  uint32_t _trace_publish_interval_ms{60000};
+  uint32_t _trace_publish_ms{0};
+  text_sensor::TextSensor *_trace_worst_text{nullptr};
+  sensor::Sensor *_trace_worst_stall_sensor{nullptr};
+  sensor::Sensor *_trace_frame_gap_sensor{nullptr};
+  sensor::Sensor *_trace_loop_load_sensor{nullptr};
+#endif
+
+#ifdef USE_RING_CLOCK_NET_WORKER
+  // --- Background Network Fetches ---
+  struct PendingFetch {
+    uint8_t id{0};  // 0 = free
+    uint8_t field_count{0};
+    FetchCallback callback;
+  };
+  void net_worker_step();
+  NetWorker _net;
+  PendingFetch _fetches[NetWorker::QUEUE_LEN * 2];
+  uint8_t _fetch_next_id{1};
+#endif
+
+#ifdef USE_RING_CLOCK_FRAME_OVERLAY
+  // --- UDP Frame Overlay ---
+  FrameOverlay _overlay;
+#endif
+
+#ifdef USE_RING_CLOCK_HISTORY
+  // --- Sensor History ---
+  static constexpr uint8_t TREND_POINTS{36};
+  // A flat trace is not stretched to full brightness: the range shown is
+  // at least this wide (°C, %RH).
+  static constexpr float TREND_MIN_RANGE_TEMP{2.0f};
+  static constexpr float TREND_MIN_RANGE_HUMID{10.0f};
+  void observe_history();
+  SensorHistory _history;
+  uint32_t _history_observe_ms{0};
+  // Sparkline points per channel (temperature, humidity), rebuilt when the
+  // history revision changes rather than on every frame.
+  float _trend[2][TREND_POINTS];
+  uint32_t _trend_rev[2]{UINT32_MAX, UINT32_MAX};
+#endif
+
+#ifdef USE_RING_CLOCK_REPLAY
+  // --- Time-warp Replay ---
+  void replay_slice();
+  ReplayRunner _replay;
+  FrameCanvas _replay_canvas;
+  state _replay_mode{state::time};
+  uint32_t _replay_slice_budget_us{8000};
+#endif
+
+  // --- Local Time Cache ---
+  // Shared by the renderers and the manual time-setting API so every caller
+  // sees the same fields and UTC offset within a frame.
+  LocalTimeCache _local_time;
 
   // --- Render Cache ---
   int _cache_h{-1};
   int _cache_m{-1};
   int _cache_s{-1};
   state _cache_mode{state::time};
+  int _cache_face{-1};
+  bool _cache_static{false};
+  bool _cache_far{false};
+
+  // --- Crossfade ---
+  // The outgoing frame is a snapshot of the rings when the transition
+  // starts; the incoming face renders into the strip buffer as usual and is
+  // then mixed with it, so no renderer runs twice in a frame.
+  static constexpr uint32_t XFADE_FRAME_MS{20};  // frame rate while fading
+  void start_transition(light::AddressableLight &it);
+  void blend_transition(light::AddressableLight &it);
+  Color _xfade_from[TOTAL_LEDS];
+  uint32_t _xfade_ms{300};
+  uint32_t _xfade_start_ms{0};
+  bool _xfade_active{false};
+  bool _xfade_requested{false};
 
   // --- Smooth Brightness State ---
   static constexpr float BRIGHTNESS_SPEED{
@@ -331,13 +984,14 @@ private:
 
   // --- Callback Managers ---
   CallbackManager<void()> _on_ready_callback_;
-  CallbackManager<void()> _on_timer_finished_callback_;
+  CallbackManager<void(uint8_t)> _on_timer_finished_callback_;
   CallbackManager<void()> _on_stopwatch_minute_callback_;
-  CallbackManager<void()> _on_timer_started_callback_;
-  CallbackManager<void()> _on_timer_stopped_callback_;
+  CallbackManager<void(uint8_t)> _on_timer_started_callback_;
+  CallbackManager<void(uint8_t)> _on_timer_stopped_callback_;
   CallbackManager<void()> _on_stopwatch_started_callback_;
   CallbackManager<void()> _on_stopwatch_paused_callback_;
   CallbackManager<void()> _on_stopwatch_reset_callback_;
+  CallbackManager<void(uint16_t, uint32_t, uint32_t)> _on_stopwatch_lap_callback_;
   CallbackManager<void()> _on_alarm_triggered_callback_;
 };
 
@@ -346,7 +1000,7 @@ class ReadyTrigger : public Trigger<> {
 public:
   explicit ReadyTrigger(RingClock *parent);
 };
-class TimerFinishedTrigger : public Trigger<> {
+class TimerFinishedTrigger : public Trigger<uint8_t> {
 public:
   explicit TimerFinishedTrigger(RingClock *parent);
 };
@@ -358,11 +1012,11 @@ class AlarmTriggeredTrigger : public Trigger<> {
 public:
   explicit AlarmTriggeredTrigger(RingClock *parent);
 };
-class TimerStartedTrigger : public Trigger<> {
+class TimerStartedTrigger : public Trigger<uint8_t> {
 public:
   explicit TimerStartedTrigger(RingClock *parent);
 };
-class TimerStoppedTrigger : public Trigger<> {
+class TimerStoppedTrigger : public Trigger<uint8_t> {
 public:
   explicit TimerStoppedTrigger(RingClock *parent);
 };
@@ -378,6 +1032,26 @@ class StopwatchResetTrigger : public Trigger<> {
 public:
   explicit StopwatchResetTrigger(RingClock *parent);
 };
+class StopwatchLapTrigger : public Trigger<uint16_t, uint32_t, uint32_t> {
+public:
+  explicit StopwatchLapTrigger(RingClock *parent);
+};
+class TimeStepTrigger : public Trigger<bool> {
+public:
+  explicit TimeStepTrigger(RingClock *parent);
+};
+class TimeAdjustedTrigger : public Trigger<> {
+public:
+  explicit TimeAdjustedTrigger(RingClock *parent);
+};
+class ChordHoldTrigger : public Trigger<> {
+public:
+  ChordHoldTrigger(RingClock *parent, uint32_t hold_ms);
+};
+class ChordReleaseTrigger : public Trigger<uint32_t> {
+public:
+  explicit ChordReleaseTrigger(RingClock *parent);
+};
 
 } // namespace ring_clock
 } // namespace esphome
@@ -0,0 +1,16 @@
+#pragma once
+
+// Hardware Definition
+// The clock consists of two rings of WS2812 LEDs
+// R1 (Inner Ring): 60 LEDs (Minutes/Seconds) - Indices 0-59
+// R2 (Outer Ring): 48 LEDs (Hours/Markers) - Indices 60-107
+#define TOTAL_LEDS 108
+#define R1_NUM_LEDS 60
+#define R2_NUM_LEDS 48
+
+// Indices of LEDs physically adjacent to the light sensor on the PCB.
+// Used to estimate LED interference when reading ambient brightness.
+// Update these if the PCB layout changes.
+#define SENSOR_ADJACENT_LED_R1 15 // Inner ring LED nearest the sensor
+#define SENSOR_ADJACENT_LED_R2                                                 \
+  12 // Outer ring LED nearest the sensor (R2-relative index)
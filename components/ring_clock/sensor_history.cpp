@@ -0,0 +1,200 @@
+#include "sensor_history.h"
+#ifdef USE_RING_CLOCK_HISTORY
+
+#include "esphome/core/log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.history";
+
+  static const uint32_t EXPORT_MAGIC = 0x31484352UL;  // "RCH1"
+  static const uint8_t EXPORT_VERSION = 1;
+  // Stored units per channel unit, indexed by HistoryChannel.
+  static const float SCALE[HISTORY_CHANNELS] = {10.0f, 10.0f, 10.0f, 100.0f};
+
+  static size_t put_varint(uint8_t *p, int32_t v) {
+    uint32_t z = ((uint32_t) v << 1) ^ (uint32_t)(v >> 31);
+    size_t n = 0;
+    while (z >= 0x80) {
+      p[n++] = (uint8_t)(z | 0x80);
+      z >>= 7;
+    }
+    p[n++] = (uint8_t) z;
+    return n;
+  }
+
+  static size_t get_varint(const uint8_t *p, size_t avail, int32_t *v) {
+    uint32_t z = 0;
+    size_t n = 0;
+    while (n < avail && n < 5) {
+      const uint8_t b = p[n];
+      z |= (uint32_t)(b & 0x7F) << (7 * n);
+      n++;
+      if (!(b & 0x80)) {
+        *v = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+        return n;
+      }
+    }
+    return 0;  // truncated
+  }
+
+  static void put_u16(uint8_t *p, uint16_t v) { memcpy(p, &v, 2); }
+  static void put_u32(uint8_t *p, uint32_t v) { memcpy(p, &v, 4); }
+
+  // --- Recording ---
+
+  void SensorHistory::configure(uint32_t interval_s, uint32_t duration_s) {
+    _interval_s = std::max<uint32_t>(interval_s, 1);
+    _duration_s = duration_s;
+    const uint32_t samples = (duration_s + _interval_s - 1) / _interval_s;
+    const size_t blocks = (samples + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES + 1;
+    _blocks.assign(std::min<size_t>(blocks, 255), Block{});
+    ESP_LOGD(TAG, "%u blocks, %u bytes", (unsigned) _blocks.size(),
+             (unsigned) (_blocks.size() * sizeof(Block)));
+  }
+
+  void SensorHistory::observe(uint32_t utc, const float values[HISTORY_CHANNELS]) {
+    const uint32_t slot = utc / _interval_s;
+    if (slot != _slot) {
+      if (_slot != 0) flush_interval();
+      _slot = slot;
+    }
+    for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+      if (std::isnan(values[c])) continue;
+      _sum[c] += values[c];
+      _n[c]++;
+    }
+  }
+
+  void SensorHistory::flush_interval() {
+    int16_t v[HISTORY_CHANNELS];
+    for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+      if (_n[c] == 0) {
+        v[c] = MISSING;
+      } else {
+        const float x = roundf(_sum[c] / _n[c] * SCALE[c]);
+        v[c] = (int16_t) std::max(-32767.0f, std::min(32767.0f, x));
+      }
+      _sum[c] = 0.0f;
+      _n[c] = 0;
+    }
+    append(_slot * _interval_s, v);
+  }
+
+  void SensorHistory::append(uint32_t utc, const int16_t values[HISTORY_CHANNELS]) {
+    if (_blocks.empty()) return;
+    LockGuard guard(_lock);
+    Block *b = &_blocks[_head];
+    const bool contiguous = b->count > 0 && utc == b->start_utc + b->count * _interval_s;
+    if (b->count > 0
+        && (!contiguous || b->count >= BLOCK_SAMPLES)) {
+      _head = (_head + 1) % _blocks.size();
+      b = &_blocks[_head];
+      b->count = 0;
+    }
+    if (b->count == 0) {
+      b->start_utc = utc;
+      b->len = 0;
+      memset(b->last, 0, sizeof(b->last));
+    }
+    for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+      b->len += put_varint(b->data + b->len, (int32_t) values[c] - b->last[c]);
+      b->last[c] = values[c];
+    }
+    b->count++;
+    _end_utc = utc + _interval_s;
+    _revision++;
+  }
+
+  // --- Reading ---
+
+  void SensorHistory::trend(HistoryChannel ch, uint32_t end_utc, uint32_t span_s, uint8_t buckets,
+                            float *out) const {
+    buckets = std::min(buckets, MAX_TREND_BUCKETS);
+    float sum[MAX_TREND_BUCKETS]{};
+    uint16_t n[MAX_TREND_BUCKETS]{};
+    const uint32_t window = span_s * buckets;
+    const uint32_t start_utc = end_utc > window ? end_utc - window : 0;
+
+    {
+      LockGuard guard(_lock);
+      for (const Block &b : _blocks) {
+        if (b.count == 0 || b.start_utc + b.count * _interval_s <= start_utc
+            || b.start_utc >= end_utc) {
+          continue;
+        }
+        int32_t last[HISTORY_CHANNELS]{};
+        size_t p = 0;
+        bool corrupt = false;
+        for (uint16_t i = 0; i < b.count && !corrupt; i++) {
+          for (uint8_t c = 0; c < HISTORY_CHANNELS; c++) {
+            int32_t d;
+            const size_t used = get_varint(b.data + p, b.len - p, &d);
+            if (used == 0) {
+              corrupt = true;  // not expected; keep what decoded, skip the rest
+              break;
+            }
+            p += used;
+            last[c] += d;
+          }
+          if (corrupt) break;
+          const uint32_t t = b.start_utc + i * _interval_s;
+          if (t < start_utc || t >= end_utc || last[ch] == MISSING) continue;
+          const uint32_t k = (t - start_utc) / span_s;
+          if (k >= buckets) continue;
+          sum[k] += last[ch];
+          n[k]++;
+        }
+      }
+    }
+
+    for (uint8_t k = 0; k < buckets; k++) {
+      out[k] = n[k] ? sum[k] / n[k] / SCALE[ch] : NAN;
+    }
+  }
+
+  // Blocks are sized for the worst case; only what they hold is exported,
+  // plus room for one more full block in case a sample lands in between.
+  size_t SensorHistory::export_size() const {
+    LockGuard guard(_lock);
+    size_t size = EXPORT_HEADER_LEN + EXPORT_BLOCK_HEADER_LEN + BLOCK_DATA_LEN;
+    for (const Block &b : _blocks) {
+      if (b.count > 0) size += EXPORT_BLOCK_HEADER_LEN + b.len;
+    }
+    return size;
+  }
+
+  size_t SensorHistory::export_to(uint8_t *out, size_t cap) const {
+    if (cap < EXPORT_HEADER_LEN) return 0;
+    LockGuard guard(_lock);
+    size_t p = EXPORT_HEADER_LEN;
+    uint16_t count = 0;
+    // Oldest block first: the one after the head, wrapping round to it.
+    for (size_t i = 1; i <= _blocks.size(); i++) {
+      const Block &b = _blocks[(_head + i) % _blocks.size()];
+      if (b.count == 0) continue;
+      if (p + EXPORT_BLOCK_HEADER_LEN + b.len > cap) break;
+      put_u32(out + p, b.start_utc);
+      put_u16(out + p + 4, b.count);
+      put_u16(out + p + 6, b.len);
+      memcpy(out + p + EXPORT_BLOCK_HEADER_LEN, b.data, b.len);
+      p += EXPORT_BLOCK_HEADER_LEN + b.len;
+      count++;
+    }
+    put_u32(out, EXPORT_MAGIC);
+    out[4] = EXPORT_VERSION;
+    out[5] = HISTORY_CHANNELS;
+    put_u16(out + 6, (uint16_t) _interval_s);
+    put_u16(out + 8, count);
+    put_u16(out + 10, 0);
+    return p;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_HISTORY
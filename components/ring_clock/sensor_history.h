@@ -0,0 +1,104 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_HISTORY
+
+#include "esphome/core/helpers.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace ring_clock {
+
+enum HistoryChannel : uint8_t {
+  HISTORY_TEMPERATURE = 0,  // 0.1 °C
+  HISTORY_HUMIDITY = 1,     // 0.1 %RH
+  HISTORY_LIGHT = 2,        // 0.1 % (ambient light sensor)
+  HISTORY_OCCUPANCY = 3,    // % of the interval occupied
+  HISTORY_CHANNELS = 4,
+};
+
+// Fixed-memory history of the room sensors.
+//
+// observe() is fed the current readings about once a second; each
+// `interval` their mean becomes one sample. Samples are stored in a ring of
+// fixed-size blocks, each holding up to BLOCK_SAMPLES consecutive samples
+// as zigzag varint deltas against the previous sample (the first against
+// zero), so a block decodes on its own. A slowly changing channel costs one
+// byte per sample; blocks have room for the widest deltas, so they always
+// close by sample count and the ring covers the full duration. A gap in
+// time (reboot, clock step) starts a new block; when the ring is full the
+// oldest block is reused. Unknown readings are stored as MISSING.
+//
+// Export format (little-endian), see export_to():
+//   u32 magic "RCH1", u8 version, u8 channels, u16 interval_s,
+//   u16 block_count, u16 reserved,
+//   per block, oldest first: u32 start_utc, u16 samples, u16 bytes, data
+class SensorHistory {
+public:
+  static constexpr uint16_t BLOCK_SAMPLES{60};
+  // Longest encoding of one sample: a 17-bit zigzag delta per channel.
+  static constexpr size_t MAX_SAMPLE_LEN{HISTORY_CHANNELS * 3};
+  static constexpr size_t BLOCK_DATA_LEN{BLOCK_SAMPLES * MAX_SAMPLE_LEN};
+  static constexpr int16_t MISSING{INT16_MIN};
+  static constexpr uint8_t MAX_TREND_BUCKETS{60};
+  static constexpr size_t EXPORT_HEADER_LEN{12};
+  static constexpr size_t EXPORT_BLOCK_HEADER_LEN{8};
+
+  // Allocates enough blocks for `duration_s` at one sample per
+  // `interval_s`, plus the block being filled.
+  void configure(uint32_t interval_s, uint32_t duration_s);
+  bool is_configured() const { return !_blocks.empty(); }
+  uint32_t get_interval_s() const { return _interval_s; }
+  uint32_t get_duration_s() const { return _duration_s; }
+
+  // Current readings at `utc` (NAN = unknown, occupancy 0 or 1).
+  void observe(uint32_t utc, const float values[HISTORY_CHANNELS]);
+
+  // Bumped on every stored sample; lets callers cache derived data.
+  uint32_t get_revision() const { return _revision; }
+  // End of the newest stored interval (0 if empty).
+  uint32_t get_end_utc() const { return _end_utc; }
+
+  // Mean of channel `ch` in `buckets` spans of span_s ending at end_utc,
+  // oldest first, in channel units (°C, %). NAN where there is no data.
+  // At most MAX_TREND_BUCKETS.
+  void trend(HistoryChannel ch, uint32_t end_utc, uint32_t span_s, uint8_t buckets,
+             float *out) const;
+
+  // Upper bound of export_to()'s output.
+  size_t export_size() const;
+  size_t export_to(uint8_t *out, size_t cap) const;
+
+protected:
+  struct Block {
+    uint32_t start_utc;
+    uint16_t count;
+    uint16_t len;
+    int16_t last[HISTORY_CHANNELS];  // previous sample, for the next delta
+    uint8_t data[BLOCK_DATA_LEN];
+  };
+
+  void append(uint32_t utc, const int16_t values[HISTORY_CHANNELS]);
+  void flush_interval();
+
+  std::vector<Block> _blocks;  // allocated once by configure()
+  uint8_t _head{0};            // block being filled
+  uint32_t _interval_s{60};
+  uint32_t _duration_s{86400};
+  uint32_t _revision{0};
+  uint32_t _end_utc{0};
+
+  // Accumulator for the interval being observed.
+  uint32_t _slot{0};  // utc / interval_s
+  float _sum[HISTORY_CHANNELS]{};
+  uint16_t _n[HISTORY_CHANNELS]{};
+
+  mutable Mutex _lock;  // render loop vs. HTTP server task
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_HISTORY
@@ -0,0 +1,258 @@
+#include "settings_store.h"
+#ifdef USE_RING_CLOCK_SETTINGS
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  static const char *const TAG = "ring_clock.settings";
+
+  static const char *const NVS_NAMESPACE = "ring_clock";
+  static const char *const NVS_KEY = "settings";
+  // ESPHome's own ESP32 backend: one blob per entity, keyed by the decimal
+  // preference hash. Read to carry values over; erased once committed here.
+  static const char *const LEGACY_NAMESPACE = "esphome";
+
+  // Blob layout: header, then per entry {key u32, len u16, data[len]}.
+  // Bump the version if that changes.
+  static const uint32_t MAGIC = 0x53435252UL;  // "RRCS"
+  static const uint16_t VERSION = 1;
+  static const size_t HEADER_LEN = 8;
+  static const size_t ENTRY_HEADER_LEN = 6;
+
+  class SettingsEntryBackend : public ESPPreferenceBackend {
+  public:
+    SettingsEntryBackend(SettingsStore *store, size_t index) : _store(store), _index(index) {}
+    bool save(const uint8_t *data, size_t len) override { return _store->save_entry(_index, data, len); }
+    bool load(uint8_t *data, size_t len) override { return _store->load_entry(_index, data, len); }
+
+  protected:
+    SettingsStore *_store;
+    size_t _index;
+  };
+
+  // --- Lifecycle ---
+
+  void SettingsStore::setup() {
+    _open = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &_nvs) == ESP_OK;
+    if (!_open) {
+      // Leave global_preferences alone; settings keep working unbatched.
+      ESP_LOGE(TAG, "Cannot open NVS namespace, settings store disabled");
+      this->mark_failed();
+      return;
+    }
+
+    size_t size = 0;
+    if (nvs_get_blob(_nvs, NVS_KEY, nullptr, &size) == ESP_OK && size > 0) {
+      _committed.resize(size);
+      if (nvs_get_blob(_nvs, NVS_KEY, _committed.data(), &size) == ESP_OK) {
+        parse(_committed);
+      } else {
+        _committed.clear();
+      }
+    }
+    ESP_LOGI(TAG, "%u settings loaded from a %u byte blob",
+             (unsigned) _entries.size(), (unsigned) _committed.size());
+
+    _previous = global_preferences;
+    global_preferences = this;
+    if (_commit_sensor != nullptr) _commit_sensor->publish_state(_commits);
+  }
+
+  void SettingsStore::loop() {
+    if (_dirty && millis() - _changed_ms >= _quiet_ms) {
+      commit();
+    }
+  }
+
+  void SettingsStore::on_shutdown() { sync(); }
+
+  // --- ESPPreferences ---
+
+  ESPPreferenceObject SettingsStore::make_preference(size_t length, uint32_t type, bool in_flash) {
+    for (size_t i = 0; i < _entries.size(); i++) {
+      if (_entries[i].key == type) {
+        _entries[i].live = true;
+        return ESPPreferenceObject(new SettingsEntryBackend(this, i));  // NOLINT
+      }
+    }
+    _entries.push_back(Entry{type, true, false, {}});
+    return ESPPreferenceObject(new SettingsEntryBackend(this, _entries.size() - 1));  // NOLINT
+  }
+
+  ESPPreferenceObject SettingsStore::make_preference(size_t length, uint32_t type) {
+    return make_preference(length, type, true);
+  }
+
+  // Explicit requests to persist (calibration, shutdown, the periodic
+  // syncer) are honoured at once; routine saves wait for the quiet period.
+  // Preferences made before the swap (e.g. the safe_mode boot counter) still
+  // live in the previous backend and are flushed with it.
+  bool SettingsStore::sync() {
+    bool ok = commit() || !_dirty;
+    if (_previous != nullptr) ok = _previous->sync() && ok;
+    return ok;
+  }
+
+  bool SettingsStore::reset() {
+    ESP_LOGW(TAG, "Erasing all settings");
+    _reset = true;
+    _entries.clear();
+    _dirty = false;
+    if (_open) {
+      nvs_erase_all(_nvs);
+      nvs_commit(_nvs);
+    }
+    return _previous == nullptr || _previous->reset();
+  }
+
+  // --- Entries ---
+
+  bool SettingsStore::save_entry(size_t index, const uint8_t *data, size_t len) {
+    if (_reset || index >= _entries.size()) return false;
+    Entry &e = _entries[index];
+    e.migrated = true;  // a fresh value supersedes the legacy key
+    if (e.data.size() == len && memcmp(e.data.data(), data, len) == 0) return true;
+    e.data.assign(data, data + len);
+    _dirty = true;
+    _changed_ms = millis();
+    return true;
+  }
+
+  bool SettingsStore::load_entry(size_t index, uint8_t *data, size_t len) {
+    if (index >= _entries.size()) return false;
+    Entry &e = _entries[index];
+    if (e.data.empty() && !migrate(e, len)) return false;
+    // A layout change in the owning component invalidates the value.
+    if (e.data.size() != len) return false;
+    memcpy(data, e.data.data(), len);
+    return true;
+  }
+
+  bool SettingsStore::migrate(Entry &e, size_t len) {
+    if (e.migrated) return false;
+    e.migrated = true;
+    nvs_handle_t legacy;
+    if (nvs_open(LEGACY_NAMESPACE, NVS_READONLY, &legacy) != ESP_OK) return false;
+    char key[11];
+    snprintf(key, sizeof(key), "%" PRIu32, e.key);
+    size_t size = len;
+    std::vector<uint8_t> buf(len);
+    const bool ok = nvs_get_blob(legacy, key, buf.data(), &size) == ESP_OK && size == len;
+    nvs_close(legacy);
+    if (!ok) return false;
+    e.data = std::move(buf);
+    e.legacy = true;
+    _dirty = true;
+    _changed_ms = millis();
+    return true;
+  }
+
+  // --- Blob ---
+
+  void SettingsStore::parse(const std::vector<uint8_t> &blob) {
+    if (blob.size() < HEADER_LEN) return;
+    uint32_t magic;
+    uint16_t version, count;
+    memcpy(&magic, &blob[0], 4);
+    memcpy(&version, &blob[4], 2);
+    memcpy(&count, &blob[6], 2);
+    if (magic != MAGIC || version != VERSION) {
+      ESP_LOGW(TAG, "Settings blob has an unknown layout, ignoring it");
+      return;
+    }
+    size_t p = HEADER_LEN;
+    for (uint16_t i = 0; i < count; i++) {
+      if (p + ENTRY_HEADER_LEN > blob.size()) break;
+      Entry e{0, false, true, {}};
+      uint16_t len;
+      memcpy(&e.key, &blob[p], 4);
+      memcpy(&len, &blob[p + 4], 2);
+      p += ENTRY_HEADER_LEN;
+      if (p + len > blob.size()) break;
+      e.data.assign(blob.begin() + p, blob.begin() + p + len);
+      p += len;
+      _entries.push_back(std::move(e));
+    }
+  }
+
+  // Only entries registered this boot are kept, so settings of removed
+  // entities fall out at the first commit.
+  void SettingsStore::serialize(std::vector<uint8_t> &out) const {
+    uint16_t count = 0;
+    size_t size = HEADER_LEN;
+    for (const Entry &e : _entries) {
+      if (!e.live || e.data.empty()) continue;
+      count++;
+      size += ENTRY_HEADER_LEN + e.data.size();
+    }
+    out.resize(size);
+    memcpy(&out[0], &MAGIC, 4);
+    memcpy(&out[4], &VERSION, 2);
+    memcpy(&out[6], &count, 2);
+    size_t p = HEADER_LEN;
+    for (const Entry &e : _entries) {
+      if (!e.live || e.data.empty()) continue;
+      const uint16_t len = e.data.size();
+      memcpy(&out[p], &e.key, 4);
+      memcpy(&out[p + 4], &len, 2);
+      memcpy(&out[p + ENTRY_HEADER_LEN], e.data.data(), len);
+      p += ENTRY_HEADER_LEN + len;
+    }
+  }
+
+  bool SettingsStore::commit() {
+    if (!_dirty || !_open || _reset) return false;
+    _dirty = false;
+    std::vector<uint8_t> blob;
+    serialize(blob);
+    if (blob == _committed) return false;  // changed and changed back
+
+    const uint32_t t0 = millis();
+    esp_err_t err = nvs_set_blob(_nvs, NVS_KEY, blob.data(), blob.size());
+    if (err == ESP_OK) err = nvs_commit(_nvs);
+    if (err != ESP_OK) {
+      ESP_LOGE(TAG, "Settings commit failed: %s", esp_err_to_name(err));
+      _dirty = true;
+      _changed_ms = millis();  // retry after another quiet period
+      return false;
+    }
+    _committed = std::move(blob);
+    _commits++;
+    ESP_LOGD(TAG, "Committed %u bytes in %u ms (commit %u)", (unsigned) _committed.size(),
+             (unsigned) (millis() - t0), (unsigned) _commits);
+    if (_commit_sensor != nullptr) _commit_sensor->publish_state(_commits);
+    erase_legacy();
+    return true;
+  }
+
+  // Migrated values are in the committed blob now; drop their old keys so
+  // they stop taking NVS space and cannot be read back by a downgrade.
+  void SettingsStore::erase_legacy() {
+    nvs_handle_t legacy;
+    bool opened = false;
+    for (Entry &e : _entries) {
+      if (!e.legacy) continue;
+      e.legacy = false;
+      if (!opened) {
+        if (nvs_open(LEGACY_NAMESPACE, NVS_READWRITE, &legacy) != ESP_OK) return;
+        opened = true;
+      }
+      char key[11];
+      snprintf(key, sizeof(key), "%" PRIu32, e.key);
+      nvs_erase_key(legacy, key);
+    }
+    if (!opened) return;
+    nvs_commit(legacy);
+    nvs_close(legacy);
+  }
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_SETTINGS
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+#ifdef USE_RING_CLOCK_SETTINGS
+
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
+#include <nvs.h>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace ring_clock {
+
+// Coalescing front end for global_preferences.
+//
+// Every restore_value global, number, switch, text and light saves through
+// global_preferences, which on ESP32 keeps one NVS key per entity and writes
+// each changed key at every periodic sync. The store installs itself as
+// global_preferences before any other component is set up and keeps all
+// values in RAM. Changes go out as one versioned blob once no setting has
+// changed for the quiet period, on an explicit sync(), or at shutdown.
+//
+// Values missing from the blob (the first boot after this was enabled) are
+// read once from their old per-entity keys and carried over; the old keys
+// are erased once the blob holding them is committed. Preferences created
+// before the swap keep their backend, and sync() flushes it as well.
+class SettingsStore : public Component, public ESPPreferences {
+public:
+  void setup() override;
+  void loop() override;
+  void on_shutdown() override;
+  // Ahead of every component that restores state in its setup().
+  float get_setup_priority() const override { return setup_priority::BUS + 10.0f; }
+
+  ESPPreferenceObject make_preference(size_t length, uint32_t type, bool in_flash) override;
+  ESPPreferenceObject make_preference(size_t length, uint32_t type) override;
+  bool sync() override;
+  bool reset() override;
+
+  void set_quiet_period(uint32_t ms) { this->_quiet_ms = ms; }
+  void set_commit_sensor(sensor::Sensor *s) { this->_commit_sensor = s; }
+  uint32_t get_commit_count() const { return _commits; }
+
+  // Entry access for the per-entity backends.
+  bool save_entry(size_t index, const uint8_t *data, size_t len);
+  bool load_entry(size_t index, uint8_t *data, size_t len);
+
+protected:
+  struct Entry {
+    uint32_t key;
+    bool live;      // registered by a component this boot
+    bool migrated;  // old per-entity key already consulted
+    std::vector<uint8_t> data;
+    bool legacy{false};  // carried over; old key erased after the next commit
+  };
+
+  void parse(const std::vector<uint8_t> &blob);
+  void serialize(std::vector<uint8_t> &out) const;
+  bool migrate(Entry &e, size_t len);
+  // Writes the blob if anything changed since the last commit.
+  bool commit();
+  void erase_legacy();
+
+  std::vector<Entry> _entries;
+  std::vector<uint8_t> _committed;  // blob as last written / read
+  ESPPreferences *_previous{nullptr};
+  nvs_handle_t _nvs{0};
+  bool _open{false};
+  bool _dirty{false};
+  bool _reset{false};
+  uint32_t _changed_ms{0};
+  uint32_t _quiet_ms{10000};
+  uint32_t _commits{0};
+  sensor::Sensor *_commit_sensor{nullptr};
+};
+
+} // namespace ring_clock
+} // namespace esphome
+
+#endif // USE_RING_CLOCK_SETTINGS
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+// WS2812-style bit encoding into RMT symbols, kept per pixel so a frame only
+// re-encodes the pixels that changed.
+//
+// A symbol is one 32-bit RMT word laid out like rmt_symbol_word_t on the
+// ESP32 family: duration0 in bits 0-14, level0 in bit 15, duration1 in bits
+// 16-30, level1 in bit 31. Each data bit is one symbol, high then low, MSB
+// first, so byte n of the pixel buffer lives at symbols[n * 8]. Nothing here
+// depends on ESP-IDF; the buffers can be checked on a host.
+class SymbolEncoder {
+public:
+  static constexpr uint8_t SYMBOLS_PER_BYTE{8};
+
+  static constexpr uint32_t symbol(uint16_t high_ticks, uint16_t low_ticks) {
+    return (high_ticks & 0x7FFFu) | 0x8000u | (uint32_t) (low_ticks & 0x7FFFu) << 16;
+  }
+  // Line low for `ticks` (the latch / reset gap), split over both halves.
+  static constexpr uint32_t reset_symbol(uint32_t ticks) {
+    const uint32_t half = ticks / 2 > 0x7FFF ? 0x7FFF : ticks / 2;
+    return half | half << 16;
+  }
+
+  // Bit timings in RMT ticks. Re-encode everything (encode_all) afterwards.
+  void set_timing(uint16_t t0h, uint16_t t0l, uint16_t t1h, uint16_t t1l) {
+    const uint32_t zero = symbol(t0h, t0l);
+    const uint32_t one = symbol(t1h, t1l);
+    for (uint8_t n = 0; n < 16; n++) {
+      for (uint8_t b = 0; b < 4; b++) _nibble[n][b] = (n & (0x8 >> b)) ? one : zero;
+    }
+  }
+
+  // The 8 symbols of one byte.
+  void encode_byte(uint8_t v, uint32_t *out) const {
+    memcpy(out, _nibble[v >> 4], sizeof(_nibble[0]));
+    memcpy(out + 4, _nibble[v & 0x0F], sizeof(_nibble[0]));
+  }
+
+  // Brings `symbols` up to date with `pixels` (num pixels of bpp bytes),
+  // re-encoding only the pixels that differ from `shadow`, the bytes last
+  // encoded, which is updated. Returns the number of pixels re-encoded.
+  size_t update(const uint8_t *pixels, uint8_t *shadow, uint32_t *symbols, size_t num, uint8_t bpp) const {
+    size_t changed = 0;
+    for (size_t i = 0; i < num; i++) {
+      const size_t off = i * bpp;
+      if (memcmp(pixels + off, shadow + off, bpp) == 0) continue;
+      encode_pixel(pixels + off, symbols + off * SYMBOLS_PER_BYTE, bpp);
+      memcpy(shadow + off, pixels + off, bpp);
+      changed++;
+    }
+    return changed;
+  }
+
+  // Encodes every pixel regardless of `shadow` (after setup or a timing change).
+  void encode_all(const uint8_t *pixels, uint8_t *shadow, uint32_t *symbols, size_t num, uint8_t bpp) const {
+    for (size_t off = 0; off < num * bpp; off += bpp) encode_pixel(pixels + off, symbols + off * SYMBOLS_PER_BYTE, bpp);
+    memcpy(shadow, pixels, num * bpp);
+  }
+
+protected:
+  void encode_pixel(const uint8_t *px, uint32_t *out, uint8_t bpp) const {
+    for (uint8_t b = 0; b < bpp; b++) encode_byte(px[b], out + b * SYMBOLS_PER_BYTE);
+  }
+
+  uint32_t _nibble[16][4]{};  // symbols of each nibble, MSB first
+};
+
+} // namespace ring_clock
+} // namespace esphome
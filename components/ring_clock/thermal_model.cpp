@@ -0,0 +1,114 @@
+#include "thermal_model.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef USE_ESP32
+#include "esp_attr.h"
+#include "esp_system.h"
+#define THERMAL_RETAIN_ATTR RTC_NOINIT_ATTR
+#else
+#define THERMAL_RETAIN_ATTR
+#endif
+
+namespace esphome {
+namespace ring_clock {
+
+  static const int ESAT_MIN_C = -20;
+  static const int ESAT_MAX_C = 80;
+
+  // 6.112 * exp(17.67 t / (t + 243.5)) at t = -20, -19, ..., 80 °C
+  static const float ESAT_TABLE[ESAT_MAX_C - ESAT_MIN_C + 1] = {
+    1.2574f, 1.3700f, 1.4915f, 1.6226f, 1.7639f, 1.9161f, 2.0800f, 2.2562f,
+    2.4457f, 2.6492f, 2.8677f, 3.1021f, 3.3535f, 3.6228f, 3.9112f, 4.2199f,
+    4.5501f, 4.9030f, 5.2800f, 5.6825f, 6.1120f, 6.5701f, 7.0583f, 7.5784f,
+    8.1322f, 8.7215f, 9.3482f, 10.0144f, 10.7223f, 11.4739f, 12.2717f, 13.1180f,
+    14.0154f, 14.9664f, 15.9739f, 17.0405f, 18.1693f, 19.3634f, 20.6258f, 21.9601f,
+    23.3695f, 24.8576f, 26.4283f, 28.0853f, 29.8325f, 31.6743f, 33.6148f, 35.6585f,
+    37.8100f, 40.0741f, 42.4558f, 44.9600f, 47.5922f, 50.3577f, 53.2622f, 56.3116f,
+    59.5118f, 62.8692f, 66.3900f, 70.0810f, 73.9490f, 78.0010f, 82.2443f, 86.6863f,
+    91.3348f, 96.1978f, 101.2834f, 106.6000f, 112.1563f, 117.9613f, 124.0241f, 130.3540f,
+    136.9609f, 143.8547f, 151.0456f, 158.5441f, 166.3611f, 174.5075f, 182.9949f, 191.8347f,
+    201.0391f, 210.6203f, 220.5909f, 230.9637f, 241.7520f, 252.9694f, 264.6297f, 276.7472f,
+    289.3363f, 302.4119f, 315.9894f, 330.0842f, 344.7124f, 359.8902f, 375.6344f, 391.9619f,
+    408.8902f, 426.4370f, 444.6206f, 463.4596f, 482.9728f,
+  };
+
+  // Last estimate, kept across software, watchdog and brownout resets the
+  // same way as the warm-boot snapshot. A power cut leaves garbage, which the
+  // check word rejects, and the board really is cold then.
+  struct RetainedRise {
+    uint32_t magic;
+    float rise;
+    uint32_t check;
+  };
+  static const uint32_t RETAIN_MAGIC = 0x54484D52UL;  // "RMHT"
+  static THERMAL_RETAIN_ATTR RetainedRise retained_rise;
+
+  static uint32_t retain_check(float rise) {
+    uint32_t bits;
+    memcpy(&bits, &rise, sizeof(bits));
+    return RETAIN_MAGIC ^ bits ^ 0xA5A5A5A5UL;
+  }
+
+  void ThermalModel::configure(float base_rise_c, float led_coefficient_c_per_w,
+                               uint32_t time_constant_s) {
+    _base_rise = base_rise_c;
+    _led_coefficient = led_coefficient_c_per_w;
+    // The only expf() in the model, evaluated once at setup.
+    _alpha = time_constant_s ? 1.0f - expf(-(STEP_MS / 1000.0f) / time_constant_s) : 1.0f;
+
+    if (retained_rise.magic == RETAIN_MAGIC && retained_rise.check == retain_check(retained_rise.rise)
+        && std::isfinite(retained_rise.rise)) {
+      _rise = retained_rise.rise;
+      _seeded = true;
+    } else {
+#ifdef USE_ESP32
+      // Not retained (e.g. an OTA image with a different RTC layout) but not
+      // a power-on either: the board is still warm, start from steady state.
+      const esp_reset_reason_t reason = esp_reset_reason();
+      _seeded = reason == ESP_RST_POWERON || reason == ESP_RST_UNKNOWN;
+#else
+      _seeded = true;
+#endif
+    }
+  }
+
+  void ThermalModel::step(float led_power_w) {
+    const float target = _base_rise + _led_coefficient * led_power_w;
+    if (!_seeded) {
+      _rise = target;
+      _seeded = true;
+    } else {
+      _rise += (target - _rise) * _alpha;
+    }
+    retained_rise.magic = RETAIN_MAGIC;
+    retained_rise.rise = _rise;
+    retained_rise.check = retain_check(_rise);
+  }
+
+  float ThermalModel::frame_power_w(light::AddressableLight &it, float channel_full_w) {
+    uint32_t sum = 0;
+    for (int i = 0; i < it.size(); i++) {
+      auto px = it[i];
+      sum += px.get_red_raw() + px.get_green_raw() + px.get_blue_raw();
+    }
+    return sum * (channel_full_w / 255.0f);
+  }
+
+  float ThermalModel::esat(float t_c) {
+    if (t_c <= ESAT_MIN_C) return ESAT_TABLE[0];
+    if (t_c >= ESAT_MAX_C) return ESAT_TABLE[ESAT_MAX_C - ESAT_MIN_C];
+    const float x = t_c - ESAT_MIN_C;
+    const int i = (int) x;
+    const float f = x - i;
+    return ESAT_TABLE[i] + (ESAT_TABLE[i + 1] - ESAT_TABLE[i]) * f;
+  }
+
+  float ThermalModel::correct_rh(float rh, float t_sensor, float t_ambient) {
+    // Same absolute moisture, different saturation pressure.
+    return rh * (esat(t_sensor) / esat(t_ambient));
+  }
+
+} // namespace ring_clock
+} // namespace esphome
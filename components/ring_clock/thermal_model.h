@@ -0,0 +1,54 @@
+#pragma once
+
+#include "esphome/components/light/addressable_light.h"
+#include "esphome/core/defines.h"
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Self-heating compensation for the on-board temperature/humidity sensor.
+//
+// The sensor sits inside the enclosure, so it reads warm by an amount that
+// follows what the board dissipates: a roughly constant share from the MCU,
+// radio and LED drivers (base_rise) plus whatever the LEDs emit. That heat
+// reaches the sensor through the enclosure with a single dominant time
+// constant, so the rise is modelled as a first-order low-pass of
+//
+//   base_rise + led_coefficient * P_led
+//
+// stepped once a second from loop(). P_led comes from the frame buffer.
+class ThermalModel {
+public:
+  void configure(float base_rise_c, float led_coefficient_c_per_w,
+                 uint32_t time_constant_s);
+
+  // Advance the model by one STEP_S with the current LED power.
+  void step(float led_power_w);
+  // Current estimated self-heating in °C (subtract from the raw reading).
+  float get_rise() const { return _rise; }
+
+  // Electrical power of a frame as transmitted (raw bytes, i.e. after
+  // brightness/gamma), given the power of one channel at full output.
+  static float frame_power_w(light::AddressableLight &it, float channel_full_w);
+
+  // Saturation vapour pressure over water, hPa (Magnus-Tetens), from a
+  // 1 °C table over -20..80 °C with linear interpolation (< 0.1 % error).
+  static float esat(float t_c);
+  // Relative humidity measured at t_sensor, re-expressed at t_ambient.
+  static float correct_rh(float rh, float t_sensor, float t_ambient);
+
+  static constexpr uint32_t STEP_MS{1000};
+
+protected:
+  float _base_rise{0.0f};
+  float _led_coefficient{0.0f};
+  float _alpha{1.0f};  // per-step smoothing factor, 1 - exp(-STEP / tau)
+  // Cold after a power-on; after a reset the retained estimate, or the
+  // steady state for the first step's LED power if none survived.
+  float _rise{0.0f};
+  bool _seeded{true};  // false: take the first step's target as is
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,116 @@
+#include "time_buttons.h"
+
+#include "esphome/core/helpers.h"
+#include <algorithm>
+
+namespace esphome {
+namespace ring_clock {
+
+  // Catch-up limit per poll() after a long loop() stall.
+  static const uint8_t MAX_REPEATS_PER_POLL = 4;
+
+  void IRAM_ATTR TimeButtons::gpio_isr(Channel *ch) {
+    const uint32_t t = micros();
+    if (!ch->burst) {
+      ch->burst = true;
+      ch->burst_us = t;
+    }
+    ch->edge_us = t;
+  }
+
+  void TimeButtons::setup() {
+    for (Channel &ch : _ch) {
+      if (ch.pin == nullptr) continue;
+      ch.pin->setup();
+      ch.down = ch.pin->digital_read();  // a button held at boot is not a press
+      ch.pin->attach_interrupt(&TimeButtons::gpio_isr, &ch, gpio::INTERRUPT_ANY_EDGE);
+    }
+    _suppress = _ch[0].down || _ch[1].down;
+  }
+
+  bool TimeButtons::settle(Channel &ch, uint32_t now_us, uint32_t *at_us) {
+    bool burst;
+    uint32_t edge, first;
+    {
+      InterruptLock lock;
+      burst = ch.burst;
+      edge = ch.edge_us;
+      first = ch.burst_us;
+    }
+    if (burst && now_us - edge < _debounce_us) return false;  // still bouncing
+    const bool level = ch.pin->digital_read();
+    if (burst) {
+      InterruptLock lock;
+      ch.burst = false;
+    }
+    if (level == ch.down) return false;  // bounced back, or no edge at all
+    ch.down = level;
+    // No recorded burst means an edge was missed; date it to now.
+    *at_us = burst ? first : now_us;
+    return true;
+  }
+
+  uint32_t TimeButtons::repeat_interval_us(uint32_t held_us) const {
+    if (held_us >= _repeat_ramp_us || _repeat_ramp_us == 0) return _repeat_min_us;
+    const uint32_t span = _repeat_start_us > _repeat_min_us ? _repeat_start_us - _repeat_min_us : 0;
+    return _repeat_start_us - (uint32_t)((uint64_t) span * held_us / _repeat_ramp_us);
+  }
+
+  void TimeButtons::poll(ButtonInput *out) {
+    *out = ButtonInput();
+    const uint32_t now = micros();
+
+    for (int i = 0; i < 2; i++) {
+      Channel &ch = _ch[i];
+      Channel &other = _ch[1 - i];
+      uint32_t at;
+      if (!settle(ch, now, &at)) continue;
+
+      if (ch.down) {
+        ch.down_us = at;
+        ch.next_repeat_us = at + _repeat_delay_us;
+        if (other.down) {
+          _chord = true;
+          _suppress = true;
+          _chord_us = at;
+          out->chord_started = true;
+        } else if (!_suppress) {
+          (i == 0 ? out->hour_steps : out->minute_steps)++;
+          (i == 0 ? out->hour_pressed : out->minute_pressed) = true;
+          (i == 0 ? out->hour_press_us : out->minute_press_us) = at;
+        }
+      } else if (!other.down) {
+        if (_chord) {
+          _chord = false;
+          out->chord_ended = true;
+          out->chord_held_ms = (at - _chord_us) / 1000;
+        } else if (!_suppress) {
+          out->released = true;
+        }
+        _suppress = false;
+      }
+    }
+
+    if (_chord) {
+      out->chord_held_ms = (now - _chord_us) / 1000;
+      return;
+    }
+    if (_suppress) return;
+
+    for (int i = 0; i < 2; i++) {
+      Channel &ch = _ch[i];
+      if (!ch.down) continue;
+      int8_t &steps = (i == 0) ? out->hour_steps : out->minute_steps;
+      for (uint8_t n = 0; n < MAX_REPEATS_PER_POLL && (int32_t)(now - ch.next_repeat_us) >= 0; n++) {
+        steps++;
+        out->repeat = true;
+        const uint32_t repeating_us = ch.next_repeat_us - ch.down_us - _repeat_delay_us;
+        ch.next_repeat_us += repeat_interval_us(repeating_us);
+      }
+      // Still behind after the cap: drop the backlog rather than race.
+      if ((int32_t)(now - ch.next_repeat_us) >= 0) ch.next_repeat_us = now + _repeat_min_us;
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
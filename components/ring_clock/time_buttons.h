@@ -0,0 +1,82 @@
+#pragma once
+
+#include "esphome/core/gpio.h"
+#include "esphome/core/hal.h"
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// What happened on the hour/minute buttons since the previous poll().
+struct ButtonInput {
+  int8_t hour_steps{0};
+  int8_t minute_steps{0};
+  bool repeat{false};         // some of the steps were auto-repeats
+  // A new press (not a repeat), dated to its first edge in micros().
+  bool hour_pressed{false};
+  bool minute_pressed{false};
+  uint32_t hour_press_us{0};
+  uint32_t minute_press_us{0};
+  bool released{false};       // adjustment finished: both buttons up
+  bool chord_started{false};  // both buttons down; pending steps are void
+  bool chord_ended{false};
+  uint32_t chord_held_ms{0};  // while the chord is held, and at its end
+};
+
+// Hour and minute buttons with ISR-timestamped edges.
+//
+// The interrupt handler only notes when edges happen. poll() accepts a new
+// level once the pin has been quiet for the debounce time and dates the
+// change to the first edge of the bounce burst, so steps and the repeat
+// schedule do not depend on loop() jitter. A held button steps once, then
+// auto-repeats after repeat_delay; the repeat interval ramps linearly from
+// repeat_interval down to repeat_min_interval over repeat_ramp. Both
+// buttons down at once is a chord: no steps, only its hold time.
+class TimeButtons {
+public:
+  void set_pins(InternalGPIOPin *hour, InternalGPIOPin *minute) {
+    _ch[0].pin = hour;
+    _ch[1].pin = minute;
+  }
+  void set_debounce(uint32_t ms) { _debounce_us = ms * 1000; }
+  void set_repeat(uint32_t delay_ms, uint32_t interval_ms, uint32_t min_interval_ms,
+                  uint32_t ramp_ms) {
+    _repeat_delay_us = delay_ms * 1000;
+    _repeat_start_us = interval_ms * 1000;
+    _repeat_min_us = min_interval_ms * 1000;
+    _repeat_ramp_us = ramp_ms * 1000;
+  }
+  bool is_configured() const { return _ch[0].pin != nullptr; }
+
+  void setup();
+  void poll(ButtonInput *out);
+
+protected:
+  struct Channel {
+    InternalGPIOPin *pin{nullptr};
+    volatile uint32_t edge_us{0};   // most recent edge
+    volatile uint32_t burst_us{0};  // first edge since the last accepted level
+    volatile bool burst{false};
+    bool down{false};
+    uint32_t down_us{0};
+    uint32_t next_repeat_us{0};
+  };
+
+  static void gpio_isr(Channel *ch);
+  // Debounced level change on ch, dated in *at_us. Returns false if none.
+  bool settle(Channel &ch, uint32_t now_us, uint32_t *at_us);
+  uint32_t repeat_interval_us(uint32_t held_us) const;
+
+  Channel _ch[2];
+  bool _chord{false};
+  bool _suppress{false};  // after a chord, ignore steps until both are up
+  uint32_t _chord_us{0};
+  uint32_t _debounce_us{30000};
+  uint32_t _repeat_delay_us{600000};
+  uint32_t _repeat_start_us{250000};
+  uint32_t _repeat_min_us{50000};
+  uint32_t _repeat_ramp_us{3000000};
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,82 @@
+#include "time_cache.h"
+
+#include "esphome/core/hal.h"
+#include <cstdlib>
+#include <sys/time.h>
+
+namespace esphome {
+namespace ring_clock {
+
+  time_t LocalTimeCache::fields_to_epoch(int year, int month, int day,
+                                         int hour, int minute, int second) {
+    int y = year, m = month;
+    if (m <= 2) { y--; m += 12; }
+    long days = 365L * y + y / 4 - y / 100 + y / 400
+              + (153 * (m - 3) + 2) / 5 + day - 719469;
+    return (time_t)(days * 86400L + (long)hour * 3600L + (long)minute * 60L + second);
+  }
+
+  int32_t LocalTimeCache::offset_at(time_t utc) {
+    struct tm lt;
+    localtime_r(&utc, &lt);
+    return (int32_t)(fields_to_epoch(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday,
+                                     lt.tm_hour, lt.tm_min, lt.tm_sec) - utc);
+  }
+
+  void LocalTimeCache::recompute(time_t utc) {
+    ESPTime &t = _snap.local;
+    t = ESPTime::from_epoch_local(utc);
+    _snap.offset = (int32_t)(fields_to_epoch(t.year, t.month, t.day_of_month,
+                                             t.hour, t.minute, t.second) - utc);
+    _base_utc = utc;
+    _base_sod = t.hour * 3600 + t.minute * 60 + t.second;
+
+    // The fields stay valid until local midnight...
+    time_t midnight = utc + (86400 - _base_sod);
+    _valid_until = midnight;
+
+    // ...unless the zone offset changes first. Transitions are rare, so one
+    // probe per day is enough; bisect to the exact second only when needed.
+    if (offset_at(midnight - 1) != _snap.offset) {
+      time_t lo = utc, hi = midnight - 1;
+      while (hi - lo > 1) {
+        time_t mid = lo + (hi - lo) / 2;
+        if (offset_at(mid) == _snap.offset) lo = mid;
+        else                                hi = mid;
+      }
+      _valid_until = hi;
+    }
+    _recompute_count++;
+  }
+
+  const LocalTime &LocalTimeCache::now() {
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    const int64_t now_ms = (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000 + _phase_ms;
+    const uint32_t sys_ms = (uint32_t) now_ms;
+    const int32_t skew = (int32_t)(sys_ms - millis());
+    const time_t utc = (time_t)(now_ms / 1000);
+    // In 64 bits: after a large step the two skews can be 2^31 apart.
+    const int64_t skew_change = (int64_t) skew - _skew_ms;
+
+    if (_valid_until == 0 || utc >= _valid_until || utc < _base_utc
+        || llabs(skew_change) > STEP_THRESHOLD_MS) {
+      recompute(utc);
+      _skew_ms = skew;
+    } else if (utc != _snap.utc) {
+      // Same local day, same offset: advance the fields arithmetically.
+      int32_t sod = _base_sod + (int32_t)(utc - _base_utc);
+      ESPTime &t = _snap.local;
+      t.hour      = sod / 3600;
+      t.minute    = (sod / 60) % 60;
+      t.second    = sod % 60;
+      t.timestamp = utc;
+    }
+
+    _snap.utc = utc;
+    _snap.ms  = (uint16_t)(now_ms % 1000);
+    return _snap;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
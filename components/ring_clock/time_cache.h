@@ -0,0 +1,70 @@
+#pragma once
+
+#include "esphome/core/time.h"
+#include <cstdint>
+#include <ctime>
+
+namespace esphome {
+namespace ring_clock {
+
+// One consistent view of the current time: local fields, the UTC second they
+// were derived from, the sub-second part, and the zone offset in effect.
+struct LocalTime {
+  ESPTime local;
+  time_t utc{0};
+  uint16_t ms{0};      // milliseconds into the current second
+  int32_t offset{0};   // local - UTC, seconds (includes DST)
+};
+
+// Incremental local-time decomposition.
+//
+// RealTimeClock::now() runs localtime_r (and with it the TZ rule parser) on
+// every call. This cache does that only when it has to: at local midnight,
+// at the next DST transition, or when the system clock is stepped. Between
+// those points hour/minute/second are advanced from the UTC epoch with plain
+// integer arithmetic, so a per-frame lookup is one gettimeofday() and a few
+// divisions.
+class LocalTimeCache {
+public:
+  // Current local time. Always internally consistent: fields and offset are
+  // computed from the same UTC instant.
+  const LocalTime &now();
+
+  // Force a full recompute on the next now(), e.g. after settimeofday() or a
+  // timezone change. Clock steps are also detected automatically.
+  void invalidate() { _valid_until = 0; }
+
+  // Offset added to the system clock before decomposition, in ms. Lets the
+  // rendered seconds be phase-shifted (LAN phase lock) without touching the
+  // system clock. Keep changes small: a jump of STEP_THRESHOLD_MS or more
+  // reads as a clock step.
+  void set_phase_offset_ms(int32_t ms) { _phase_ms = ms; }
+  int32_t get_phase_offset_ms() const { return _phase_ms; }
+
+  // Number of full localtime_r() decompositions performed (diagnostics).
+  uint32_t get_recompute_count() const { return _recompute_count; }
+
+  // Proleptic Gregorian calendar fields -> Unix epoch.
+  // Pure arithmetic: no mktime(), no TZ environment side-effects.
+  static time_t fields_to_epoch(int year, int month, int day, int hour,
+                                int minute, int second);
+
+protected:
+  // A disagreement between the system clock and millis() larger than this
+  // means someone stepped the clock (SNTP, RTC read, manual set).
+  static constexpr int32_t STEP_THRESHOLD_MS{1000};
+
+  void recompute(time_t utc);
+  static int32_t offset_at(time_t utc);
+
+  LocalTime _snap;
+  time_t _base_utc{0};     // UTC second the cached fields were decomposed at
+  int32_t _base_sod{0};    // local seconds-of-day at _base_utc
+  time_t _valid_until{0};  // first UTC second the cached day/offset is wrong
+  int32_t _skew_ms{0};     // (system ms - millis()) at the last recompute
+  int32_t _phase_ms{0};    // render phase offset, see set_phase_offset_ms()
+  uint32_t _recompute_count{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
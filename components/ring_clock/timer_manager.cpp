@@ -0,0 +1,81 @@
+#include "timer_manager.h"
+
+#include <utility>
+
+namespace esphome {
+namespace ring_clock {
+
+  bool TimerHeap::push(uint8_t id, uint32_t deadline_ms, uint32_t duration_ms) {
+    if (id >= MAX_TIMERS) return false;
+
+    // Re-arming a running timer: drop the old entry first so ids stay unique.
+    this->remove(id);
+
+    uint8_t i = _count++;
+    _slots[i] = TimerSlot{id, deadline_ms, duration_ms};
+    sift_up(i);
+    return true;
+  }
+
+  bool TimerHeap::remove(uint8_t id) {
+    int i = index_of(id);
+    if (i < 0) return false;
+
+    _count--;
+    if (i == _count) return true;
+
+    // Move the last leaf into the hole and restore heap order in whichever
+    // direction it is violated.
+    _slots[i] = _slots[_count];
+    sift_down(i);
+    sift_up(i);
+    return true;
+  }
+
+  bool TimerHeap::pop_expired(uint32_t now_ms, TimerSlot *out) {
+    if (_count == 0) return false;
+    if ((int32_t)(now_ms - _slots[0].deadline_ms) < 0) return false;
+
+    *out = _slots[0];
+    _count--;
+    if (_count > 0) {
+      _slots[0] = _slots[_count];
+      sift_down(0);
+    }
+    return true;
+  }
+
+  const TimerSlot *TimerHeap::find(uint8_t id) const {
+    int i = index_of(id);
+    return i < 0 ? nullptr : &_slots[i];
+  }
+
+  int TimerHeap::index_of(uint8_t id) const {
+    for (uint8_t i = 0; i < _count; i++) {
+      if (_slots[i].id == id) return i;
+    }
+    return -1;
+  }
+
+  void TimerHeap::sift_up(uint8_t i) {
+    while (i > 0) {
+      uint8_t parent = (i - 1) / 2;
+      if (!before(_slots[i], _slots[parent])) break;
+      std::swap(_slots[i], _slots[parent]);
+      i = parent;
+    }
+  }
+
+  void TimerHeap::sift_down(uint8_t i) {
+    for (;;) {
+      uint8_t l = 2 * i + 1, r = l + 1, m = i;
+      if (l < _count && before(_slots[l], _slots[m])) m = l;
+      if (r < _count && before(_slots[r], _slots[m])) m = r;
+      if (m == i) break;
+      std::swap(_slots[i], _slots[m]);
+      i = m;
+    }
+  }
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Number of countdown timers that can run at the same time.
+// Timer ids are 0 .. MAX_TIMERS-1; id 0 is the legacy single timer.
+#define MAX_TIMERS 4
+
+struct TimerSlot {
+  uint8_t id;
+  uint32_t deadline_ms; // millis() value at which the timer expires
+  uint32_t duration_ms; // full duration, used for progress rendering
+};
+
+// Fixed-capacity binary min-heap of running countdown timers, keyed on
+// deadline. The earliest deadline is always at the root, so loop() only has
+// to look at one slot per tick regardless of how many timers are running.
+// Deadlines are compared with wrap-safe signed arithmetic so the heap keeps
+// working across the 49-day millis() rollover.
+class TimerHeap {
+public:
+  // Insert a timer, or re-arm it if the id is already running.
+  // Returns false when the id is out of range.
+  bool push(uint8_t id, uint32_t deadline_ms, uint32_t duration_ms);
+
+  // Remove a running timer by id. Returns false if it was not running.
+  bool remove(uint8_t id);
+
+  // Pop the earliest timer if it has expired at now_ms.
+  bool pop_expired(uint32_t now_ms, TimerSlot *out);
+
+  // Earliest-deadline timer, or nullptr when empty.
+  const TimerSlot *peek() const { return _count ? &_slots[0] : nullptr; }
+
+  // Running timer with this id, or nullptr.
+  const TimerSlot *find(uint8_t id) const;
+
+  uint8_t size() const { return _count; }
+  bool empty() const { return _count == 0; }
+  void clear() { _count = 0; }
+
+protected:
+  static bool before(const TimerSlot &a, const TimerSlot &b) {
+    return (int32_t)(a.deadline_ms - b.deadline_ms) < 0;
+  }
+  int index_of(uint8_t id) const;
+  void sift_up(uint8_t i);
+  void sift_down(uint8_t i);
+
+  TimerSlot _slots[MAX_TIMERS];
+  uint8_t _count{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
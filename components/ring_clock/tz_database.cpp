@@ -0,0 +1,70 @@
+#include "tz_database.h"
+
+#include <cstring>
+
+namespace esphome {
+namespace ring_clock {
+
+  void TimezoneDatabase::set_data(const uint8_t *data, size_t len) {
+    _zone_count = 0;
+    if (data == nullptr || len < 4) return;
+
+    uint16_t zones   = u16(data);
+    uint8_t  regions = data[2];
+    uint8_t  rules   = data[3];
+    size_t pool_at = 4 + zones * 4 + regions * 2 + rules * 2;
+    if (pool_at >= len) return;
+
+    _zones        = data + 4;
+    _regions      = _zones + zones * 4;
+    _rules        = _regions + regions * 2;
+    _pool         = (const char *)(data + pool_at);
+    _region_count = regions;
+    _rule_count   = rules;
+    _zone_count   = zones;
+  }
+
+  int TimezoneDatabase::compare(const char *iana, uint16_t i) const {
+    const uint8_t *e = entry(i);
+    const char *region = string_at(u16(_regions + e[2] * 2));
+    const char *city   = string_at(u16(e));
+
+    // Walk "Region" + "/" + "City" as one virtual string.
+    const char *parts[3] = {region, "/", city};
+    const unsigned char *a = (const unsigned char *)iana;
+    for (const char *part : parts) {
+      for (const unsigned char *b = (const unsigned char *)part; *b; a++, b++) {
+        if (*a != *b) return (int)*a - (int)*b;
+      }
+    }
+    return *a;  // zero only when iana ends exactly here
+  }
+
+  const char *TimezoneDatabase::lookup(const char *iana) const {
+    if (iana == nullptr || _zone_count == 0) return nullptr;
+    int lo = 0, hi = (int)_zone_count - 1;
+    while (lo <= hi) {
+      int mid = (lo + hi) / 2;
+      int c = compare(iana, mid);
+      if (c == 0) return string_at(u16(_rules + entry(mid)[3] * 2));
+      if (c < 0) hi = mid - 1;
+      else       lo = mid + 1;
+    }
+    return nullptr;
+  }
+
+  bool TimezoneDatabase::name_at(uint16_t i, char *buf, size_t buf_len) const {
+    if (i >= _zone_count || buf_len == 0) return false;
+    const uint8_t *e = entry(i);
+    const char *region = string_at(u16(_regions + e[2] * 2));
+    const char *city   = string_at(u16(e));
+    size_t rl = strlen(region), cl = strlen(city);
+    if (rl + 1 + cl + 1 > buf_len) return false;
+    memcpy(buf, region, rl);
+    buf[rl] = '/';
+    memcpy(buf + rl + 1, city, cl + 1);
+    return true;
+  }
+
+} // namespace ring_clock
+} // namespace esphome
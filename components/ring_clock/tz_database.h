@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Read-only IANA name -> POSIX TZ rule table, generated by __init__.py from
+// static/*.json and compiled into flash. Layout (little-endian):
+//
+//   u16 zone_count, u8 region_count, u8 rule_count
+//   zone_count   x { u16 city_offset, u8 region_index, u8 rule_index }
+//   region_count x u16 region_offset
+//   rule_count   x u16 rule_offset
+//   string pool of NUL-terminated strings (offsets are relative to it)
+//
+// Zones are sorted bytewise by "Region/City". Region prefixes and POSIX
+// rules are interned, so the ~460 zones share 11 regions and ~90 rules.
+class TimezoneDatabase {
+public:
+  void set_data(const uint8_t *data, size_t len);
+  bool is_loaded() const { return _zone_count > 0; }
+  uint16_t size() const { return _zone_count; }
+
+  // Binary search for an IANA name such as "Australia/Sydney".
+  // Returns the POSIX rule (pointing into flash), or nullptr if unknown.
+  const char *lookup(const char *iana) const;
+
+  // Writes zone i's IANA name into buf; returns false if it does not fit.
+  bool name_at(uint16_t i, char *buf, size_t buf_len) const;
+
+protected:
+  const uint8_t *entry(uint16_t i) const { return _zones + i * 4; }
+  const char *string_at(uint16_t offset) const { return _pool + offset; }
+  static uint16_t u16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+  // strcmp() of iana against zone i's "Region/City" without building it.
+  int compare(const char *iana, uint16_t i) const;
+
+  const uint8_t *_zones{nullptr};
+  const uint8_t *_regions{nullptr};
+  const uint8_t *_rules{nullptr};
+  const char *_pool{nullptr};
+  uint16_t _zone_count{0};
+  uint8_t _region_count{0};
+  uint8_t _rule_count{0};
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,88 @@
+#include "warm_boot.h"
+
+#include "esphome/core/helpers.h"
+#include <cstddef>
+#include <cstring>
+
+#ifdef USE_ESP32
+#include "esp_attr.h"
+#define WARM_BOOT_ATTR RTC_NOINIT_ATTR
+#else
+// No retained RAM on this target: only the NVS copy survives.
+#define WARM_BOOT_ATTR
+#endif
+
+namespace esphome {
+namespace ring_clock {
+
+  // Bump the version if the snapshot layout or units change.
+  static const char *const PREF_KEY = "ring_clock_warm_boot";
+  static const uint32_t MAGIC = 0x524E4757UL;  // "WGNR"
+  static const uint16_t VERSION = 1;
+
+  static const uint32_t FNV_OFFSET = 2166136261UL;
+  static const uint32_t FNV_PRIME  = 16777619UL;
+
+  // Not initialised by the startup code; a cold boot leaves garbage here,
+  // which the checksum rejects.
+  static WARM_BOOT_ATTR WarmBootSnapshot rtc_snapshot;
+
+  uint32_t WarmBootStore::checksum(const WarmBootSnapshot &snap) {
+    const uint8_t *p = reinterpret_cast<const uint8_t *>(&snap);
+    uint32_t h = FNV_OFFSET;
+    for (size_t i = 0; i < offsetof(WarmBootSnapshot, checksum); i++) {
+      h ^= p[i];
+      h *= FNV_PRIME;
+    }
+    return h;
+  }
+
+  bool WarmBootStore::is_valid(const WarmBootSnapshot &snap) {
+    return snap.magic == MAGIC && snap.version == VERSION
+        && snap.timer_count <= MAX_TIMERS && snap.checksum == checksum(snap);
+  }
+
+  bool WarmBootStore::load() {
+    _pref = global_preferences->make_preference<WarmBootSnapshot>(fnv1_hash(PREF_KEY));
+    WarmBootSnapshot nvs;
+    _nvs_has_state = _pref.load(&nvs) && is_valid(nvs) && !nvs.empty();
+
+    if (is_valid(rtc_snapshot)) {
+      memcpy(&_pending, &rtc_snapshot, sizeof(_pending));
+    } else if (_nvs_has_state) {
+      memcpy(&_pending, &nvs, sizeof(_pending));
+    } else {
+      memset(&_pending, 0, sizeof(_pending));
+    }
+    _has_pending = !_pending.empty();
+    return _has_pending;
+  }
+
+  void WarmBootStore::consume() {
+    _has_pending = false;
+    if (_nvs_has_state) {
+      WarmBootSnapshot blank;
+      memset(&blank, 0, sizeof(blank));
+      _pref.save(&blank);
+      _nvs_has_state = false;
+    }
+  }
+
+  void WarmBootStore::update(WarmBootSnapshot &snap) {
+    snap.magic = MAGIC;
+    snap.version = VERSION;
+    snap.checksum = checksum(snap);
+    memcpy(&rtc_snapshot, &snap, sizeof(snap));
+  }
+
+  void WarmBootStore::commit() {
+    if (!is_valid(rtc_snapshot)) return;
+    // Nothing running and nothing stored: skip the flash write.
+    if (rtc_snapshot.empty() && !_nvs_has_state) return;
+    _pref.save(&rtc_snapshot);
+    global_preferences->sync();
+    _nvs_has_state = !rtc_snapshot.empty();
+  }
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "esphome/core/preferences.h"
+#include "timer_manager.h"
+#include <cstdint>
+
+namespace esphome {
+namespace ring_clock {
+
+// Countdown, stopwatch and alarm state as it must survive a reset.
+//
+// millis() restarts from zero on every boot, so everything here is an
+// absolute UTC instant in milliseconds. The owner converts to and from its
+// millis()-relative fields; this file only stores and validates.
+struct WarmBootSnapshot {
+  static constexpr uint8_t STOPWATCH_RUNNING{1 << 0};
+  static constexpr uint8_t STOPWATCH_PAUSED{1 << 1};
+  static constexpr uint8_t ALARM_ACTIVE{1 << 2};
+
+  struct Timer {
+    int64_t deadline_utc_ms;
+    uint32_t duration_ms;
+    uint8_t id;
+  };
+
+  uint32_t magic;
+  uint16_t version;
+  uint8_t timer_count;
+  uint8_t flags;
+  Timer timers[MAX_TIMERS];
+  int64_t stopwatch_start_utc_ms; // STOPWATCH_RUNNING: instant elapsed was 0
+  uint32_t stopwatch_paused_ms;   // STOPWATCH_PAUSED: elapsed when paused
+  int64_t alarm_utc_ms;           // ALARM_ACTIVE: instant the alarm fired
+  uint32_t checksum;              // FNV-1a over everything above
+
+  bool empty() const { return timer_count == 0 && flags == 0; }
+};
+
+// Two copies of the snapshot are kept:
+//  - RTC memory that the bootloader leaves untouched across software,
+//    watchdog and brownout resets. Refreshed on every change; costs a
+//    memcpy, so it can be written as often as the state moves.
+//  - NVS, written only from on_shutdown(). Covers clean restarts and OTA
+//    updates, where the new image may place the RTC copy elsewhere.
+// The RTC copy wins when its checksum holds, being the more recent.
+class WarmBootStore {
+public:
+  // Loads both copies. Returns true if either held a non-empty snapshot,
+  // which is then available from pending().
+  bool load();
+  const WarmBootSnapshot *pending() const { return _has_pending ? &_pending : nullptr; }
+  // Drop the pending snapshot once applied. A stale NVS copy is erased so
+  // a later power cut cannot bring it back.
+  void consume();
+
+  // Seal and store in RTC memory.
+  void update(WarmBootSnapshot &snap);
+  // Copy the current RTC snapshot to NVS (clean shutdown).
+  void commit();
+
+protected:
+  static uint32_t checksum(const WarmBootSnapshot &snap);
+  static bool is_valid(const WarmBootSnapshot &snap);
+
+  WarmBootSnapshot _pending{};
+  bool _has_pending{false};
+  bool _nvs_has_state{false};
+  ESPPreferenceObject _pref;
+};
+
+} // namespace ring_clock
+} // namespace esphome
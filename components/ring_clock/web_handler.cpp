@@ -0,0 +1,117 @@
+#include "web_handler.h"
+#include "ring_clock.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace esphome {
+namespace ring_clock {
+
+  void RingClockWebSetup::setup() { _parent->register_web_handler(); }
+
+  bool RingClockWebHandler::canHandle(AsyncWebServerRequest *request) const {
+    return request->method() == HTTP_GET && str_startswith(request->url(), "/ring_clock/");
+  }
+
+  void RingClockWebHandler::handleRequest(AsyncWebServerRequest *request) {
+    const std::string url = request->url();
+    if (url == "/ring_clock/frame") {
+      handle_frame(request);
+      return;
+    }
+    if (url == "/ring_clock/history.bin") {
+      handle_history(request);
+      return;
+    }
+    if (url == "/ring_clock/trace") {
+      handle_trace(request);
+      return;
+    }
+    if (str_startswith(url, "/ring_clock/static/")) {
+      handle_static(request, url.substr(sizeof("/ring_clock/static/") - 1));
+      return;
+    }
+    request->send(404);
+  }
+
+  void RingClockWebHandler::handle_frame(AsyncWebServerRequest *request) {
+    FramePreview *preview = _parent->get_frame_preview();
+    if (preview == nullptr) {
+      request->send(404);
+      return;
+    }
+    // Missing or stale seq -> the client gets a keyframe.
+    int32_t since = -1;
+    if (request->hasArg("since")) {
+      since = (int32_t)(strtoul(request->arg("since").c_str(), nullptr, 10) & 0xFFFF);
+    }
+    // Per request: a shared buffer could be rebuilt by a second poll while
+    // the first response is still going out.
+    std::vector<uint8_t> out(PREVIEW_MAX_RESPONSE);
+    const size_t len = preview->build_response(since, out.data(), millis());
+
+    auto *response = request->beginResponse(200, "application/octet-stream", out.data(), len);
+    response->addHeader("Cache-Control", "no-store");
+    response->addHeader("Access-Control-Allow-Origin", "*");
+    request->send(response);
+  }
+
+  void RingClockWebHandler::handle_history(AsyncWebServerRequest *request) {
+#ifdef USE_RING_CLOCK_HISTORY
+    SensorHistory *history = _parent->get_sensor_history();
+    if (history->is_configured()) {
+      // A few KB once per dashboard refresh; not worth a permanent buffer.
+      std::vector<uint8_t> out(history->export_size());
+      const size_t len = history->export_to(out.data(), out.size());
+      auto *response = request->beginResponse(200, "application/octet-stream", out.data(), len);
+      response->addHeader("Cache-Control", "no-store");
+      response->addHeader("Access-Control-Allow-Origin", "*");
+      request->send(response);
+      return;
+    }
+#endif
+    request->send(404);
+  }
+
+  void RingClockWebHandler::handle_trace(AsyncWebServerRequest *request) {
+#ifdef USE_RING_CLOCK_LOOP_TRACE
+    const std::string body = _parent->get_loop_tracer()->dump();
+    auto *response = request->beginResponse(200, "application/json", body.c_str());
+    response->addHeader("Cache-Control", "no-store");
+    response->addHeader("Access-Control-Allow-Origin", "*");
+    request->send(response);
+#else
+    request->send(404);
+#endif
+  }
+
+  void RingClockWebHandler::handle_static(AsyncWebServerRequest *request, const std::string &name) {
+#ifdef USE_RING_CLOCK_LOCAL_ASSETS
+    const LocalAsset *asset = _parent->find_local_asset(name);
+    if (asset != nullptr) {
+      char cache[40];
+      snprintf(cache, sizeof(cache), "public, max-age=%u", (unsigned) _parent->get_local_asset_max_age());
+      // Unchanged since the browser's copy: headers only.
+      auto inm = request->get_header("If-None-Match");
+      if (inm.has_value() && *inm == asset->etag) {
+        auto *response = request->beginResponse(304, asset->content_type);
+        response->addHeader("ETag", asset->etag);
+        response->addHeader("Cache-Control", cache);
+        request->send(response);
+        return;
+      }
+      auto *response = request->beginResponse(200, asset->content_type, asset->data, asset->len);
+      if (asset->gzipped) response->addHeader("Content-Encoding", "gzip");
+      response->addHeader("ETag", asset->etag);
+      response->addHeader("Cache-Control", cache);
+      response->addHeader("Access-Control-Allow-Origin", "*");
+      request->send(response);
+      return;
+    }
+#endif
+    request->send(404);
+  }
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "esphome/components/web_server_base/web_server_base.h"
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "frame_preview.h"
+
+namespace esphome {
+namespace ring_clock {
+
+class RingClock;
+
+#ifdef USE_RING_CLOCK_LOCAL_ASSETS
+// A file from static/ compiled into flash by __init__.py (`local_assets:`).
+struct LocalAsset {
+  const char *name;
+  const char *content_type;
+  const uint8_t *data;
+  size_t len;
+  const char *etag;  // quoted, from a hash of the uncompressed file
+  bool gzipped;
+};
+#endif
+
+// HTTP endpoints served by the component on the existing web_server port.
+// All routes live under /ring_clock/ so they never collide with web_server.
+//
+//   GET /ring_clock/frame?since=<seq>   live LED preview (see FramePreview)
+//   GET /ring_clock/history.bin         sensor history (see SensorHistory)
+//   GET /ring_clock/trace               main loop trace (see LoopTracer)
+//   GET /ring_clock/static/<file>       web UI assets from flash (LocalAsset)
+class RingClockWebHandler : public AsyncWebHandler {
+public:
+  explicit RingClockWebHandler(RingClock *parent) : _parent(parent) {}
+
+  bool canHandle(AsyncWebServerRequest *request) const override;
+  void handleRequest(AsyncWebServerRequest *request) override;
+
+protected:
+  void handle_frame(AsyncWebServerRequest *request);
+  void handle_history(AsyncWebServerRequest *request);
+  void handle_trace(AsyncWebServerRequest *request);
+  void handle_static(AsyncWebServerRequest *request, const std::string &name);
+
+  RingClock *_parent;
+};
+
+// Registers RingClockWebHandler right after WiFi, as web_server does: the
+// HTTP server cannot start before the network stack, and RingClock itself
+// sets up much earlier for the boot frame.
+class RingClockWebSetup : public Component {
+public:
+  explicit RingClockWebSetup(RingClock *parent) : _parent(parent) {}
+
+  void setup() override;
+  float get_setup_priority() const override { return setup_priority::WIFI - 1.0f; }
+
+protected:
+  RingClock *_parent;
+};
+
+} // namespace ring_clock
+} // namespace esphome
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Fetch and decode an AL60's sensor history (ring_clock `history:`).
+
+    python3 scripts/history_fetch.py al60.local > history.csv
+    python3 scripts/history_fetch.py --file history.bin
+
+Prints CSV: utc, temperature (°C), humidity (%RH), light (%), occupancy
+(fraction of the interval). Empty fields are readings the clock did not
+have. See SensorHistory in components/ring_clock/sensor_history.h for the
+binary format.
+"""
+
+import argparse
+import struct
+import sys
+import urllib.request
+
+MAGIC = 0x31484352
+MISSING = -32768
+SCALE = (10.0, 10.0, 10.0, 100.0)
+
+
+def varints(data):
+    z = shift = 0
+    for b in data:
+        z |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            yield (z >> 1) ^ -(z & 1)
+            z = shift = 0
+
+
+def decode(blob):
+    magic, version, channels, interval, count, _ = struct.unpack_from("<IBBHHH", blob)
+    if magic != MAGIC or version != 1:
+        raise ValueError("not a ring_clock history export")
+    p = 12
+    for _ in range(count):
+        start, samples, length = struct.unpack_from("<IHH", blob, p)
+        p += 8
+        deltas = varints(blob[p:p + length])
+        p += length
+        last = [0] * channels
+        for i in range(samples):
+            for c in range(channels):
+                last[c] += next(deltas)
+            yield start + i * interval, [None if v == MISSING else v / SCALE[c]
+                                         for c, v in enumerate(last)]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("host", nargs="?", help="clock host name or IP")
+    parser.add_argument("--file", help="decode a saved history.bin instead")
+    args = parser.parse_args()
+    if args.file:
+        with open(args.file, "rb") as f:
+            blob = f.read()
+    elif args.host:
+        with urllib.request.urlopen(f"http://{args.host}/ring_clock/history.bin", timeout=10) as r:
+            blob = r.read()
+    else:
+        parser.error("give a host or --file")
+
+    out = sys.stdout
+    out.write("utc,temperature,humidity,light,occupancy\n")
+    for utc, values in decode(blob):
+        out.write(",".join([str(utc)] + ["" if v is None else f"{v:g}" for v in values]) + "\n")
+
+
+if __name__ == "__main__":
+    main()
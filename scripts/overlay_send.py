@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Send test frames to an AL60 `frame_overlay:` over DDP or E1.31.
+
+    python3 scripts/overlay_send.py al60.local --pattern doorbell
+    python3 scripts/overlay_send.py 192.168.1.50 --protocol e131 --pattern chase
+    python3 scripts/overlay_send.py al60.local --rgba --pattern fade --duration 5
+
+Pixels are in strip order: R1 (0-59), then R2 (60-107). Without --rgba,
+black pixels are transparent and the clock face shows through; with
+--rgba every pixel carries its own alpha (configure `rgba: true`).
+Stop sending and the overlay disappears after the clock's `timeout`.
+"""
+
+import argparse
+import math
+import socket
+import struct
+import time
+
+LEDS = 108
+R1 = 60
+DDP_PORT = 4048
+E131_PORT = 5568
+
+
+def ddp_packet(data, seq):
+    # Version 1, PUSH: one packet is the whole frame. Type 0x0B (RGB, 8 bit)
+    # is informational; the clock takes the layout from its `rgba` option.
+    return struct.pack(">BBBBIH", 0x41, seq & 0x0F, 0x0B, 1, 0, len(data)) + data
+
+
+def e131_packet(data, seq, universe, cid=b"AL60-overlay-tx"[:16].ljust(16, b"\0")):
+    dmp = struct.pack(">HBBHHH", 0x7000 | (10 + len(data) + 1), 0x02, 0xA1, 0, 1,
+                      len(data) + 1) + b"\0" + data
+    framing = struct.pack(">HI64sBHBBH", 0x7000 | (77 + len(dmp)), 0x00000002,
+                          b"overlay_send.py", 100, 0, seq & 0xFF, 0, universe) + dmp
+    root = struct.pack(">HH12sHI16s", 0x0010, 0, b"ASC-E1.17\0\0\0",
+                       0x7000 | (22 + len(framing)), 0x00000004, cid) + framing
+    return root
+
+
+def frame(pattern, t, rgba):
+    """One frame as a list of (r, g, b, a) tuples."""
+    px = [(0, 0, 0, 0)] * LEDS
+    if pattern == "doorbell":
+        # Both rings flash blue twice a second.
+        on = int(t * 4) % 2 == 0
+        px = [(0, 60, 255, 255) if on else (0, 0, 0, 0)] * LEDS
+    elif pattern == "chase":
+        head = int(t * 60) % R1
+        for i in range(8):
+            px[(head - i) % R1] = (255, 40, 0, 255 - i * 30)
+    elif pattern == "fade":
+        # Red wash fading in and out over the face (alpha only shows with --rgba).
+        a = int(127 + 127 * math.sin(t * 2))
+        px = [(255, 0, 0, a)] * LEDS
+    elif pattern == "quarters":
+        for i in range(0, R1, 15):
+            px[i] = (255, 255, 255, 255)
+        for i in range(R1, LEDS, 12):
+            px[i] = (0, 255, 0, 255)
+    out = bytearray()
+    for r, g, b, a in px:
+        if rgba:
+            out += bytes((r, g, b, a))
+        elif a >= 128:
+            out += bytes((r, g, b))
+        else:
+            out += bytes(3)  # black: transparent
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("host", help="clock host name or IP")
+    parser.add_argument("--protocol", choices=["ddp", "e131"], default="ddp")
+    parser.add_argument("--port", type=int, help="default 4048 (DDP) or 5568 (E1.31)")
+    parser.add_argument("--universe", type=int, default=1)
+    parser.add_argument("--rgba", action="store_true", help="send 4 channels per pixel")
+    parser.add_argument("--pattern", choices=["doorbell", "chase", "fade", "quarters"],
+                        default="doorbell")
+    parser.add_argument("--fps", type=float, default=30)
+    parser.add_argument("--duration", type=float, default=3, help="seconds, 0 = forever")
+    args = parser.parse_args()
+
+    port = args.port or (DDP_PORT if args.protocol == "ddp" else E131_PORT)
+    addr = (socket.gethostbyname(args.host), port)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    start = time.monotonic()
+    seq = 0
+    try:
+        while args.duration == 0 or time.monotonic() - start < args.duration:
+            data = frame(args.pattern, time.monotonic() - start, args.rgba)
+            if args.protocol == "ddp":
+                packet = ddp_packet(data, seq)
+            else:
+                packet = e131_packet(data, seq, args.universe)
+            sock.sendto(packet, addr)
+            seq += 1
+            time.sleep(1.0 / args.fps)
+    except KeyboardInterrupt:
+        pass
+    print(f"Sent {seq} frames to {addr[0]}:{addr[1]}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+"""LAN phase-lock beacon for AL60 clocks (ring_clock `phase_lock:`).
+
+Send beacons at this host's second boundaries, so every follower on the
+segment ticks with the host clock:
+
+    python3 scripts/phase_beacon.py
+
+Listen to a leader clock and print its phase against the host clock (run
+NTP/chrony on the host for the comparison to mean anything):
+
+    python3 scripts/phase_beacon.py --listen
+
+Beacon layout (little-endian, 16 bytes): magic "AL6P", version u8, flags u8,
+seq u16, unix seconds u32, milliseconds u16, reserved u16.
+"""
+
+import argparse
+import socket
+import struct
+import time
+
+MAGIC = 0x50364C41
+VERSION = 1
+BEACON = struct.Struct("<IBBHIHH")
+
+
+def send(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_TTL, 1)
+    if args.interface:
+        sock.setsockopt(socket.IPPROTO_IP, socket.IP_MULTICAST_IF,
+                        socket.inet_aton(args.interface))
+    seq = 0
+    print(f"Sending beacons to {args.group}:{args.port} (offset {args.offset} ms)")
+    while True:
+        # Sleep to just past the next (offset) second boundary.
+        now = time.time() + args.offset / 1000.0
+        time.sleep(1.0 - (now % 1.0) + 0.0005)
+        now_ms = int((time.time() + args.offset / 1000.0) * 1000)
+        packet = BEACON.pack(MAGIC, VERSION, 0, seq & 0xFFFF, now_ms // 1000, now_ms % 1000, 0)
+        sock.sendto(packet, (args.group, args.port))
+        if args.verbose:
+            print(f"seq {seq} at .{now_ms % 1000:03d}")
+        seq += 1
+
+
+def listen(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", args.port))
+    iface = socket.inet_aton(args.interface or "0.0.0.0")
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP,
+                    socket.inet_aton(args.group) + iface)
+    print(f"Listening on {args.group}:{args.port}")
+    while True:
+        data, (addr, _) = sock.recvfrom(64)
+        host_ms = int(time.time() * 1000)
+        if len(data) != BEACON.size:
+            continue
+        magic, version, _, seq, unix_s, ms, _ = BEACON.unpack(data)
+        if magic != MAGIC or version != VERSION:
+            continue
+        # Phase of the sender's tick relative to the host's, wrapped to +-500.
+        err = (ms - host_ms % 1000 + 500) % 1000 - 500
+        print(f"{addr} seq {seq:5d}  {time.strftime('%H:%M:%S', time.gmtime(unix_s))}.{ms:03d}  "
+              f"phase vs host {err:+4d} ms  seconds vs host {unix_s - host_ms // 1000:+d}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--group", default="239.255.60.60")
+    parser.add_argument("--port", type=int, default=6060)
+    parser.add_argument("--interface", help="local IPv4 address of the LAN interface")
+    parser.add_argument("--offset", type=int, default=0,
+                        help="shift the sent phase by this many ms (test slewing)")
+    parser.add_argument("--listen", action="store_true", help="print received beacons")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    args = parser.parse_args()
+    try:
+        listen(args) if args.listen else send(args)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,20 @@
+#!/bin/bash
+set -e
+
+# Builds and runs the host tests in this directory with g++. Each
+# *_test.cpp is a standalone program against headers in components/ring_clock
+# that have no ESPHome or ESP-IDF dependency.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+COMPONENT_DIR="$SCRIPT_DIR/../components/ring_clock"
+BUILD_DIR="$(mktemp -d)"
+trap 'rm -rf "$BUILD_DIR"' EXIT
+CXX="${CXX:-g++}"
+
+status=0
+for src in "$SCRIPT_DIR"/*_test.cpp; do
+  name="$(basename "$src" .cpp)"
+  "$CXX" -std=c++17 -O1 -Wall -Wextra -Werror -I "$COMPONENT_DIR" "$src" -o "$BUILD_DIR/$name"
+  "$BUILD_DIR/$name" || status=1
+done
+exit $status
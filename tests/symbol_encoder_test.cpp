@@ -0,0 +1,124 @@
+// Host test for components/ring_clock/symbol_encoder.h: symbol words for a
+// few pixels in each rgb_order, and the changed-pixel count of update().
+// Run with tests/run_host_tests.sh.
+
+#include "symbol_encoder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using esphome::ring_clock::SymbolEncoder;
+
+static int failures = 0;
+
+#define CHECK_EQ(actual, expected)                                                                    \
+  do {                                                                                                \
+    const unsigned long long a_ = (actual), e_ = (expected);                                          \
+    if (a_ != e_) {                                                                                   \
+      std::printf("%s:%d: %s is 0x%llx, expected 0x%llx\n", __FILE__, __LINE__, #actual, a_, e_); \
+      failures++;                                                                                     \
+    }                                                                                                 \
+  } while (0)
+
+// WS2812 at 100 ns ticks (as light.py computes them): 0 = 400/1000 ns,
+// 1 = 1000/400 ns. Level 1 first, then level 0.
+static const uint32_t ZERO = 0x000A8004;  // duration0 4, level0 1, duration1 10
+static const uint32_t ONE = 0x0004800A;   // duration0 10, level0 1, duration1 4
+
+static const uint8_t BPP = 3;
+
+// Pixel bytes as RingClockLedOutput::get_view_internal() places them.
+static void put_pixel(std::vector<uint8_t> &buf, size_t i, const std::string &order, uint8_t r, uint8_t g,
+                      uint8_t b) {
+  buf[i * BPP + order.find('R')] = r;
+  buf[i * BPP + order.find('G')] = g;
+  buf[i * BPP + order.find('B')] = b;
+}
+
+// Symbols expected for `bytes` on the wire, MSB first.
+static std::vector<uint32_t> expected_symbols(const std::vector<uint8_t> &bytes) {
+  std::vector<uint32_t> out;
+  for (uint8_t v : bytes) {
+    for (int bit = 7; bit >= 0; bit--) out.push_back((v >> bit) & 1 ? ONE : ZERO);
+  }
+  return out;
+}
+
+static void check_symbols(const std::vector<uint32_t> &symbols, size_t pixel, const std::vector<uint8_t> &wire) {
+  const std::vector<uint32_t> want = expected_symbols(wire);
+  for (size_t k = 0; k < want.size(); k++) CHECK_EQ(symbols[pixel * BPP * 8 + k], want[k]);
+}
+
+static void test_symbol_words() {
+  CHECK_EQ(SymbolEncoder::symbol(4, 10), ZERO);
+  CHECK_EQ(SymbolEncoder::symbol(10, 4), ONE);
+  // 300 us latch gap: both halves low, 1500 ticks each.
+  CHECK_EQ(SymbolEncoder::reset_symbol(3000), 0x05DC05DCu);
+  CHECK_EQ(SymbolEncoder::reset_symbol(200000), 0x7FFF7FFFu);
+}
+
+static void test_rgb_orders() {
+  SymbolEncoder enc;
+  enc.set_timing(4, 10, 10, 4);
+  for (const char *order : {"RGB", "GRB", "BGR", "BRG"}) {
+    const std::string o = order;
+    const size_t num = 3;
+    std::vector<uint8_t> pixels(num * BPP), shadow(num * BPP);
+    std::vector<uint32_t> symbols(num * BPP * 8);
+    put_pixel(pixels, 0, o, 0xFF, 0x00, 0x00);
+    put_pixel(pixels, 1, o, 0x12, 0x34, 0x56);
+    put_pixel(pixels, 2, o, 0x80, 0x01, 0xA5);
+    enc.encode_all(pixels.data(), shadow.data(), symbols.data(), num, BPP);
+
+    const uint8_t colours[num][3] = {{0xFF, 0x00, 0x00}, {0x12, 0x34, 0x56}, {0x80, 0x01, 0xA5}};
+    for (size_t i = 0; i < num; i++) {
+      std::vector<uint8_t> wire(BPP);
+      for (size_t c = 0; c < BPP; c++) wire[c] = colours[i][std::string("RGB").find(o[c])];
+      check_symbols(symbols, i, wire);
+    }
+    CHECK_EQ(std::memcmp(shadow.data(), pixels.data(), pixels.size()), 0);
+  }
+}
+
+static void test_update_counts_changed_pixels() {
+  SymbolEncoder enc;
+  enc.set_timing(4, 10, 10, 4);
+  const size_t num = 108;
+  std::vector<uint8_t> pixels(num * BPP), shadow(num * BPP);
+  std::vector<uint32_t> symbols(num * BPP * 8);
+  enc.encode_all(pixels.data(), shadow.data(), symbols.data(), num, BPP);
+
+  CHECK_EQ(enc.update(pixels.data(), shadow.data(), symbols.data(), num, BPP), 0);
+
+  put_pixel(pixels, 0, "GRB", 0x01, 0x02, 0x03);
+  put_pixel(pixels, 59, "GRB", 0xFF, 0xFF, 0xFF);
+  pixels[107 * BPP + 2] = 0x40;  // one byte of the last pixel
+  CHECK_EQ(enc.update(pixels.data(), shadow.data(), symbols.data(), num, BPP), 3);
+  check_symbols(symbols, 0, {0x02, 0x01, 0x03});
+  check_symbols(symbols, 59, {0xFF, 0xFF, 0xFF});
+  check_symbols(symbols, 107, {0x00, 0x00, 0x40});
+  check_symbols(symbols, 60, {0x00, 0x00, 0x00});
+
+  // Nothing changed since: no work, symbols untouched.
+  CHECK_EQ(enc.update(pixels.data(), shadow.data(), symbols.data(), num, BPP), 0);
+  check_symbols(symbols, 59, {0xFF, 0xFF, 0xFF});
+
+  // Back to black re-encodes the pixel again.
+  put_pixel(pixels, 59, "GRB", 0, 0, 0);
+  CHECK_EQ(enc.update(pixels.data(), shadow.data(), symbols.data(), num, BPP), 1);
+  check_symbols(symbols, 59, {0x00, 0x00, 0x00});
+}
+
+int main() {
+  test_symbol_words();
+  test_rgb_orders();
+  test_update_counts_changed_pixels();
+  if (failures) {
+    std::printf("symbol_encoder_test: %d failure(s)\n", failures);
+    return 1;
+  }
+  std::printf("symbol_encoder_test: ok\n");
+  return 0;
+}